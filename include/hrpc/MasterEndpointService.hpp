@@ -88,7 +88,7 @@ public:
 
 		server->resource["/_zpds/master/v1/endpoint$"]["POST"]
 		=[this,stptr,rkeeper](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_HRPC, response, request, [this,stptr,response,request] {
 				std::string output;
 				int ecode=M_UNKNOWN;
 				try
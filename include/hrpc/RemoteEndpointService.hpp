@@ -82,7 +82,7 @@ public:
 
 		server->resource["/_zpds/remote/v1/endpoint$"]["POST"]
 		=[this,stptr,rkeeper](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,rkeeper,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_HRPC, response, request, [this,stptr,rkeeper,response,request] {
 				std::string output;
 				int ecode=M_UNKNOWN;
 				try
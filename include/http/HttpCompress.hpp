@@ -0,0 +1,226 @@
+/**
+ * @project zapdos
+ * @file include/http/HttpCompress.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  HttpCompress.hpp : Gzip and deflate of response bodies Headers
+ *
+ */
+#ifndef _ZPDS_HTTP_COMPRESS_HPP_
+#define _ZPDS_HTTP_COMPRESS_HPP_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "Utility.hpp"
+
+#define ZPDS_HTTP_COMPRESS_LEVEL 1
+#define ZPDS_HTTP_COMPRESS_CACHE 1000
+// bodies larger than this are not kept for reuse
+#define ZPDS_HTTP_COMPRESS_CACHE_MAXLEN 65536
+
+namespace zpds {
+namespace http {
+
+/**
+* Gzip or deflate of bodies at least threshold long for clients that accept it. The last few
+* compressed bodies are kept by their uncompressed bytes , so repeated responses like
+* popular completions are sent precompressed.
+*
+*/
+class HttpCompress {
+
+public:
+	using pointer = std::shared_ptr<HttpCompress>;
+	using BodyT = std::shared_ptr<const std::string>;
+
+	enum EncodingE {
+		ENC_NONE    = 0,
+		ENC_GZIP    = 1,
+		ENC_DEFLATE = 2
+	};
+
+	/**
+	* Create : create HttpCompress
+	*
+	* @param threshold_
+	*   size_t min body length to compress
+	*
+	* @param level_
+	*   int zlib level 1 to 9
+	*
+	* @param cache_items_
+	*   size_t compressed bodies kept , 0 for none
+	*
+	* @return
+	*   std::shared_ptr<HttpCompress>
+	*
+	*/
+	static pointer Create(size_t threshold_, int level_=ZPDS_HTTP_COMPRESS_LEVEL, size_t cache_items_=ZPDS_HTTP_COMPRESS_CACHE)
+	{
+		return std::make_shared<HttpCompress>(threshold_, level_, cache_items_);
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param threshold_
+	*   size_t min body length to compress
+	*
+	* @param level_
+	*   int zlib level 1 to 9
+	*
+	* @param cache_items_
+	*   size_t compressed bodies kept , 0 for none
+	*
+	*/
+	HttpCompress(size_t threshold_, int level_, size_t cache_items_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	HttpCompress() = delete;
+	HttpCompress(const HttpCompress&) = delete;
+	HttpCompress& operator=(const HttpCompress&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~HttpCompress ();
+
+	/**
+	* Accepts : encoding to use from the Accept-Encoding header , gzip preferred
+	*
+	* @param header
+	*   const CaseInsensitiveMultimap& request header
+	*
+	* @return
+	*   EncodingE
+	*/
+	static EncodingE Accepts(const CaseInsensitiveMultimap& header);
+
+	/**
+	* GetName : Content-Encoding value
+	*
+	* @param enc
+	*   EncodingE encoding
+	*
+	* @return
+	*   const char*
+	*/
+	static const char* GetName(EncodingE enc);
+
+	/**
+	* Compress : compressed body if long enough , from the kept ones if there
+	*
+	* @param payload
+	*   const std::string& payload
+	*
+	* @param enc
+	*   EncodingE encoding
+	*
+	* @return
+	*   BodyT nullptr if not to be compressed
+	*/
+	BodyT Compress(const std::string& payload, EncodingE enc);
+
+	/**
+	* GetCompressed : bodies compressed
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetCompressed() const;
+
+	/**
+	* GetCacheHits : bodies sent precompressed
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetCacheHits() const;
+
+	/**
+	* GetBytesIn : uncompressed bytes of bodies sent compressed
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetBytesIn() const;
+
+	/**
+	* GetBytesOut : compressed bytes sent
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetBytesOut() const;
+
+protected:
+	struct EntryT {
+		std::string payload;
+		BodyT body;
+	};
+	using EntryMapT = std::unordered_map<size_t, EntryT>;
+
+	const size_t threshold;
+	const int level;
+	const size_t cache_items;
+
+	std::mutex cache_lock;
+	EntryMapT cache;
+	std::deque<size_t> order;
+
+	std::atomic<uint64_t> compressed;
+	std::atomic<uint64_t> cache_hits;
+	std::atomic<uint64_t> bytes_in;
+	std::atomic<uint64_t> bytes_out;
+
+	/**
+	* Deflate : compress with zlib
+	*
+	* @param payload
+	*   const std::string& payload
+	*
+	* @param enc
+	*   EncodingE encoding
+	*
+	* @return
+	*   std::string
+	*/
+	std::string Deflate(const std::string& payload, EncodingE enc) const;
+
+};
+
+} // namespace http
+} // namespace zpds
+
+#endif  // _ZPDS_HTTP_COMPRESS_HPP_
@@ -36,6 +36,7 @@
 #include "AsioCompat.hpp"
 #include "Mutex.hpp"
 #include "Utility.hpp"
+#include "HttpCompress.hpp"
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -69,6 +70,12 @@ public:
 		std::shared_ptr<Session> session;
 		long timeout_content;
 
+	public:
+		/// Compression of large bodies , set from Config , nullptr if off.
+		std::shared_ptr<HttpCompress> compress;
+
+	private:
+
 		Mutex send_queue_mutex;
 		std::list<std::pair<std::shared_ptr<asio::streambuf>, std::function<void(const error_code &)>>> send_queue GUARDED_BY(send_queue_mutex);
 
@@ -337,6 +344,9 @@ protected:
 
 		std::unique_ptr<asio::steady_timer> timer;
 
+		/// Bytes of pipelined requests read along with the one being served.
+		std::string pipelined;
+
 		void close() noexcept
 		{
 			error_code ec;
@@ -398,6 +408,10 @@ public:
 		long timeout_request = 5;
 		/// Timeout on request/response content completion. Defaults to 300 seconds.
 		long timeout_content = 300;
+		/// Timeout waiting for the next request on a persistent connection. Defaults to 0 , same as timeout_request.
+		long timeout_keep_alive = 0;
+		/// Compression of large bodies for clients that accept it. Defaults to nullptr , off.
+		std::shared_ptr<HttpCompress> compress;
 		/// Maximum size of request stream buffer. Defaults to architecture maximum.
 		/// Reaching this limit will result in a message_size error code.
 		std::size_t max_request_streambuf_size = (std::numeric_limits<std::size_t>::max)();
@@ -556,9 +570,9 @@ protected:
 		return connection;
 	}
 
-	void read(const std::shared_ptr<Session> &session)
+	void read(const std::shared_ptr<Session> &session, bool next = false)
 	{
-		session->connection->set_timeout(config.timeout_request);
+		session->connection->set_timeout((next && config.timeout_keep_alive > 0) ? config.timeout_keep_alive : config.timeout_request);
 		asio::async_read_until(*session->connection->socket, session->request->streambuf, "\r\n\r\n", [this, session](const error_code &ec, std::size_t bytes_transferred) {
 			session->connection->set_timeout(config.timeout_content);
 			auto lock = session->connection->handler_runner->continue_lock();
@@ -599,6 +613,8 @@ protected:
 							this->on_error(session->request, make_error_code::make_error_code(errc::message_size));
 						return;
 					}
+					if(content_length < num_additional_bytes)
+						this->keep_pipelined(session, content_length);
 					if(content_length > num_additional_bytes) {
 						asio::async_read(*session->connection->socket, session->request->streambuf, asio::transfer_exactly(content_length - num_additional_bytes), [this, session](const error_code &ec, std::size_t /*bytes_transferred*/) {
 							auto lock = session->connection->handler_runner->continue_lock();
@@ -626,14 +642,42 @@ protected:
 
 					this->read_chunked_transfer_encoded(session, chunk_size_streambuf);
 				}
-				else
+				else {
+					if(num_additional_bytes > 0)
+						this->keep_pipelined(session, 0);
 					this->find_resource(session);
+				}
 			}
 			else if(this->on_error)
 				this->on_error(session->request, ec);
 		});
 	}
 
+	/// Move bytes beyond the content of this request to the connection , they are the next requests.
+	void keep_pipelined(const std::shared_ptr<Session> &session, std::size_t content_length)
+	{
+		auto &source = session->request->streambuf;
+		auto begin = asio::buffers_begin(source.data());
+		auto end = asio::buffers_end(source.data());
+		session->connection->pipelined.append(begin + content_length, end);
+		std::string content(begin, begin + content_length);
+		source.consume(source.size());
+		if(content_length > 0)
+			source.commit(asio::buffer_copy(source.prepare(content_length), asio::buffer(content)));
+	}
+
+	/// Session for the next request on a persistent connection , starting with pipelined bytes if any.
+	std::shared_ptr<Session> next_session(const std::shared_ptr<Connection> &connection)
+	{
+		auto session = std::make_shared<Session>(this->config.max_request_streambuf_size, connection);
+		if(!connection->pipelined.empty()) {
+			auto &target = session->request->streambuf;
+			target.commit(asio::buffer_copy(target.prepare(connection->pipelined.size()), asio::buffer(connection->pipelined)));
+			connection->pipelined.clear();
+		}
+		return session;
+	}
+
 	void read_chunked_transfer_encoded(const std::shared_ptr<Session> &session, const std::shared_ptr<asio::streambuf> &chunk_size_streambuf)
 	{
 		asio::async_read_until(*session->connection->socket, *chunk_size_streambuf, "\r\n", [this, session, chunk_size_streambuf](const error_code &ec, size_t bytes_transferred) {
@@ -782,14 +826,12 @@ protected:
 						if(case_insensitive_equal(it->second, "close"))
 							return;
 						else if(case_insensitive_equal(it->second, "keep-alive")) {
-							auto new_session = std::make_shared<Session>(this->config.max_request_streambuf_size, response->session->connection);
-							this->read(new_session);
+							this->read(this->next_session(response->session->connection), true);
 							return;
 						}
 					}
 					if(response->session->request->http_version >= "1.1") {
-						auto new_session = std::make_shared<Session>(this->config.max_request_streambuf_size, response->session->connection);
-						this->read(new_session);
+						this->read(this->next_session(response->session->connection), true);
 						return;
 					}
 				}
@@ -797,6 +839,7 @@ protected:
 					this->on_error(response->session->request, ec);
 			});
 		});
+		response->compress = config.compress;
 
 		try {
 			resource_function(response, session->request);
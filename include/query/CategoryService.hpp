@@ -126,7 +126,7 @@ public:
 
 		server->resource["/_admin/api/v1/category/(create|upsert|update|delete)$"]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -219,7 +219,7 @@ public:
 
 		server->resource["/_admin/api/v1/category/(getone|getmany)$"]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
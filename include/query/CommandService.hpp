@@ -91,7 +91,7 @@ public:
 
 		server->resource["/_admin/api/v1/local_command/(.*)$"]["GET"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -120,6 +120,9 @@ public:
 
 					else if ( request->path_match[1]=="commitnow" ) {
 #ifdef ZPDS_BUILD_WITH_XAPIAN
+						// write out queued index changes first
+						if (stptr->xapindexer && !stptr->xapindexer->Flush(stptr->logcounter.Get(), XAP_COMMIT_DEFAULT_WAIT_MS) )
+							throw zpds::BadDataException("Index pipeline busy, commit not done");
 						stptr->xapdb->CommitData();
 						errt.set_status("OK");
 #else
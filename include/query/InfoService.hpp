@@ -75,7 +75,7 @@ public:
 
 		server->resource["/help$"]["GET"]
 		=[this,stptr,scope,helpquery](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,scope,helpquery,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,scope,helpquery,response,request] {
 				try
 				{
 					DLOG(INFO) << request->path;
@@ -106,7 +106,7 @@ public:
 
 		server->resource["/help.html$"]["GET"]
 		=[this,stptr,scope,helpquery](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,scope,helpquery,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,scope,helpquery,response,request] {
 				try
 				{
 					DLOG(INFO) << request->path;
@@ -131,7 +131,7 @@ public:
 
 		server->resource["/info$"]["GET"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				try
 				{
 					LOG(INFO) << request->path;
@@ -158,6 +158,129 @@ public:
 			});
 		};
 
+		// Endpoint : GET stats
+		helpquery->add({scope,"GET stats", { "Gets internal counters of this server" } });
+
+		server->resource["/stats$"]["GET"]
+		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
+				try
+				{
+					LOG(INFO) << request->path;
+					::zpds::query::StatsT sstats;
+					sstats.set_ts( ZPDS_CURRTIME_MS );
+					auto addcounter = [&sstats](const std::string& name, uint64_t value) {
+						auto c = sstats.add_counters();
+						c->set_name(name);
+						c->set_value(value);
+					};
+
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+					if (stptr->xapdb) {
+						auto snap = stptr->xapdb->GetSnapshot();
+						addcounter("xap_generation", snap->generation );
+						addcounter("xap_committed_at", snap->committed_at );
+						addcounter("xap_doccount", snap->doccount );
+						addcounter("xap_pending_docs", stptr->xapdb->GetPendingDocs() );
+						addcounter("xap_pending_bytes", stptr->xapdb->GetPendingBytes() );
+					}
+					if (stptr->xapcommit) {
+						addcounter("xap_commits", stptr->xapcommit->GetCommits() );
+						addcounter("xap_commit_waits", stptr->xapcommit->GetWaits() );
+					}
+					if (stptr->xapindexer) {
+						uint64_t logid = stptr->logcounter.Get();
+						uint64_t indexed = stptr->xapindexer->GetLastIndexed();
+						addcounter("xap_index_last_logid", indexed );
+						addcounter("xap_index_lag", (logid > indexed) ? logid - indexed : 0 );
+						addcounter("xap_index_inflight", stptr->xapindexer->GetInflight() );
+						addcounter("xap_index_gaps", stptr->xapindexer->GetGaps() );
+					}
+					if (stptr->xappool) {
+						addcounter("xap_pool_hits", stptr->xappool->GetHits() );
+						addcounter("xap_pool_misses", stptr->xappool->GetMisses() );
+						addcounter("xap_pool_reopens", stptr->xappool->GetReopens() );
+						addcounter("xap_freshness_lag_ms", stptr->xappool->GetLastLag() );
+						addcounter("xap_freshness_max_lag_ms", stptr->xappool->GetMaxLag() );
+						addcounter("xap_geocol_builds", stptr->xappool->GetColumnBuilds() );
+						addcounter("xap_geocol_updates", stptr->xappool->GetColumnUpdates() );
+						addcounter("xap_geocol_rows", stptr->xappool->GetColumnRows() );
+						addcounter("xap_prefix_builds", stptr->xappool->GetPrefixBuilds() );
+						addcounter("xap_prefix_updates", stptr->xappool->GetPrefixUpdates() );
+						addcounter("xap_prefix_nodes", stptr->xappool->GetPrefixNodes() );
+					}
+					if (stptr->xapresults) {
+						uint64_t hits = stptr->xapresults->GetHits();
+						uint64_t lookups = hits + stptr->xapresults->GetMisses();
+						addcounter("xap_result_hits", hits );
+						addcounter("xap_result_misses", lookups - hits );
+						addcounter("xap_result_hit_permille", (lookups>0) ? (1000 * hits) / lookups : 0 );
+						addcounter("xap_result_rejects", stptr->xapresults->GetRejects() );
+						addcounter("xap_result_evictions", stptr->xapresults->GetEvictions() );
+						addcounter("xap_result_entries", stptr->xapresults->GetEntries() );
+						addcounter("xap_result_bytes", stptr->xapresults->GetBytes() );
+					}
+#endif
+
+					if (stptr->httpcompress) {
+						addcounter("http_gzip_compressed", stptr->httpcompress->GetCompressed() );
+						addcounter("http_gzip_cache_hits", stptr->httpcompress->GetCacheHits() );
+						addcounter("http_gzip_bytes_in", stptr->httpcompress->GetBytesIn() );
+						addcounter("http_gzip_bytes_out", stptr->httpcompress->GetBytesOut() );
+					}
+
+					if (stptr->dbcache) {
+						uint64_t hits=0, misses=0, evictions=0, bytes=0, entries=0;
+						for (size_t i=0 ; i < stptr->dbcache->GetShards() ; ++i) {
+							std::string pre = "dbcache_shard_" + std::to_string(i);
+							addcounter(pre + "_hits", stptr->dbcache->GetHits(i) );
+							addcounter(pre + "_misses", stptr->dbcache->GetMisses(i) );
+							hits += stptr->dbcache->GetHits(i);
+							misses += stptr->dbcache->GetMisses(i);
+							evictions += stptr->dbcache->GetEvictions(i);
+							bytes += stptr->dbcache->GetBytes(i);
+							entries += stptr->dbcache->GetEntries(i);
+						}
+						addcounter("dbcache_hits", hits );
+						addcounter("dbcache_misses", misses );
+						addcounter("dbcache_evictions", evictions );
+						addcounter("dbcache_bytes", bytes );
+						addcounter("dbcache_entries", entries );
+					}
+
+					if (stptr->sesscache) {
+						addcounter("session_cache_hits", stptr->sesscache->GetHits() );
+						addcounter("session_cache_misses", stptr->sesscache->GetMisses() );
+						addcounter("session_cache_users", stptr->sesscache->GetEntries() );
+					}
+
+					if (stptr->reqsched) {
+						for (size_t i=0 ; i < ::zpds::utils::RequestScheduler::REQ_CLASSES ; ++i) {
+							auto cls = ::zpds::utils::RequestScheduler::ClassE(i);
+							std::string pre = std::string("sched_") + ::zpds::utils::RequestScheduler::GetName(cls);
+							addcounter(pre + "_threads", stptr->reqsched->GetThreads(cls) );
+							addcounter(pre + "_depth", stptr->reqsched->GetDepth(cls) );
+							addcounter(pre + "_accepted", stptr->reqsched->GetAccepted(cls) );
+							addcounter(pre + "_done", stptr->reqsched->GetDone(cls) );
+							addcounter(pre + "_shed", stptr->reqsched->GetShed(cls) );
+							addcounter(pre + "_expired", stptr->reqsched->GetExpired(cls) );
+							addcounter(pre + "_wait_us_avg", stptr->reqsched->GetWaitAvg(cls) );
+							addcounter(pre + "_wait_us_max", stptr->reqsched->GetWaitMax(cls) );
+						}
+					}
+
+					// aftermath
+					std::string output;
+					pb2json(&sstats, output);
+					this->HttpOKAction(response,request,200,"OK","application/json",output);
+				}
+				catch (...)
+				{
+					this->HttpErrorAction(response,request,500,"INTERNAL SERVER ERROR");
+				}
+			});
+		};
+
 	}
 
 private:
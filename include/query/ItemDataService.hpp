@@ -104,7 +104,7 @@ public:
 		                                   ")$"};
 		server->resource[itemdata_write]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -228,7 +228,7 @@ public:
 
 		server->resource["/(_admin|_user)/api/v1/(localdata|wikidata)/(getone|getmany)$"]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -102,7 +102,7 @@ public:
 
 		server->resource["/(_admin|_user)/api/v1/login$"]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -186,7 +186,7 @@ public:
 
 		server->resource["/(_admin|_user)/api/v1/resetpass$"]["POST"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_ADMIN, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
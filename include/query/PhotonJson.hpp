@@ -0,0 +1,76 @@
+/**
+ * @project zapdos
+ * @file include/query/PhotonJson.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PhotonJson.hpp : Schema specific json writer for search responses Headers
+ *
+ */
+#ifndef _ZPDS_QUERY_PHOTONJSON_HPP_
+#define _ZPDS_QUERY_PHOTONJSON_HPP_
+
+#include <string>
+
+#include "query/ProtoJson.hpp"
+#include "../proto/Query.pb.h"
+
+namespace zpds {
+namespace query {
+
+/**
+ * photon2json : Convert photon result to json , same bytes as pb2json without reflection
+ *
+ * @param msg
+ *   const PhotonResultT* from msg pointer
+ *
+ * @param str
+ *   std::string& to string , appended
+ *
+ * @return
+ *   none
+ */
+void photon2json(const PhotonResultT* msg, std::string& str);
+
+/**
+ * wiki2json : Convert wiki completion result to json , same bytes as pb2json without reflection
+ *   only unique_id , title and summary are written as filled by SearchWiki
+ *
+ * @param msg
+ *   const ItemResultT* from msg pointer
+ *
+ * @param str
+ *   std::string& to string , appended
+ *
+ * @return
+ *   none
+ */
+void wiki2json(const ItemResultT* msg, std::string& str);
+
+}
+}
+
+#endif // _ZPDS_QUERY_PHOTONJSON_HPP_
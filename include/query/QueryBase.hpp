@@ -37,8 +37,6 @@
 #include "utils/SharedTable.hpp"
 
 #include <async++.h>
-// #define ZPDS_PARALLEL_ONE async::parallel_invoke
-#define ZPDS_PARALLEL_ONE async::spawn
 
 #include <functional>
 #include <boost/algorithm/string.hpp>
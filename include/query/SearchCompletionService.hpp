@@ -34,6 +34,7 @@
 #define _ZPDS_QUERY_SEARCH_COMPLETION_SERVICE_HPP_
 
 #include "query/QueryBase.hpp"
+#include "query/PhotonJson.hpp"
 
 #ifdef ZPDS_BUILD_WITH_XAPIAN
 #include "search/SearchLocal.hpp"
@@ -117,7 +118,7 @@ public:
 
 		server->resource["/_query/api/v1/(photon|notoph|textdata)/(.*)$"]["GET"]
 		=[this,stptr](typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request) {
-			ZPDS_PARALLEL_ONE([this,stptr,response,request] {
+			this->Schedule(stptr->reqsched, ::zpds::utils::RequestScheduler::REQ_QUERY, response, request, [this,stptr,response,request] {
 				uint64_t currtime = ZPDS_CURRTIME_MS;
 				bool ok=false;
 
@@ -208,16 +209,15 @@ public:
 					std::string output;
 
 #ifdef ZPDS_BUILD_WITH_XAPIAN
-					std::string xapath = stptr->xapath.Get();
 					if ( request->path_match[1] == "textdata" ) {
-						zpds::search::SearchWiki rs(xapath);
+						zpds::search::SearchWiki rs(stptr->xappool);
 						rs.CompletionQueryAction(stptr, &data);
-						pb2json(data.mutable_wikidata(),output);
+						wiki2json(data.mutable_wikidata(),output);
 					}
 					else {
-						zpds::search::SearchLocal rs(xapath);
+						zpds::search::SearchLocal rs(stptr->xappool);
 						rs.CompletionQueryAction(stptr, &data);
-						pb2json(data.mutable_photondata(),output);
+						photon2json(data.mutable_photondata(),output);
 					}
 #else
 					throw zpds::InitialException("Search is not enabled on this machine");
@@ -35,7 +35,10 @@
 
 #include <fstream>
 #include <iomanip>
+#include <async++.h>
 #include "utils/BaseUtils.hpp"
+#include "utils/RequestScheduler.hpp"
+#include "http/HttpCompress.hpp"
 
 #ifdef ZPDS_BUILD_WITH_CTEMPLATE
 #include <ctemplate/template.h>
@@ -68,6 +71,40 @@ protected:
 	*/
 	ServiceBase(const unsigned int myscope_) : myscope(myscope_) {}
 
+	/**
+	* Schedule : run the handler on the threads of its class , 503 if refused or late
+	*
+	* @param sched
+	*   ::zpds::utils::RequestScheduler::pointer scheduler , if null runs on async threadpool
+	*
+	* @param cls
+	*   ::zpds::utils::RequestScheduler::ClassE traffic class
+	*
+	* @param response
+	*   typename HttpServerT::RespPtr response
+	*
+	* @param request
+	*   typename HttpServerT::ReqPtr request
+	*
+	* @param action
+	*   ::zpds::utils::RequestScheduler::TaskT&& handler
+	*
+	* @return
+	*   none
+	*/
+	void Schedule(::zpds::utils::RequestScheduler::pointer sched, ::zpds::utils::RequestScheduler::ClassE cls,
+	              typename HttpServerT::RespPtr response, typename HttpServerT::ReqPtr request,
+	              ::zpds::utils::RequestScheduler::TaskT&& action)
+	{
+		if (!sched) {
+			async::spawn( std::move(action) );
+			return;
+		}
+		sched->Submit(cls, std::move(action), [this,response,request] {
+			this->HttpErrorAction(response,request,503,"SERVICE UNAVAILABLE");
+		});
+	}
+
 	/**
 	* HttpErrorAction : Error Action Template no payload maybe template
 	*
@@ -157,8 +194,25 @@ protected:
 	{
 		*response << "HTTP/" << request->http_version << " " << ec <<  " " << em << "\r\n";
 		*response << "Content-Type: " << content_type << "\r\n";
+
+		// compressed if large and accepted
+		if (response->compress) {
+			auto enc = ::zpds::http::HttpCompress::Accepts(request->header);
+			auto body = response->compress->Compress(payload, enc);
+			if (body) {
+				*response << "Content-Encoding: " << ::zpds::http::HttpCompress::GetName(enc) << "\r\n";
+				*response << "Vary: Accept-Encoding\r\n";
+				*response << "Content-Length: " << body->length() << "\r\n";
+				*response << "\r\n";
+				response->write( body->data(), body->length() );
+				DLOG(INFO) << "OK: " << payload;
+				return;
+			}
+		}
+
 		*response << "Content-Length: " << payload.length() << "\r\n";
-		*response << "\r\n" << payload.c_str();
+		*response << "\r\n";
+		response->write( payload.data(), payload.length() );
 		DLOG(INFO) << "OK: " << payload;
 	}
 
@@ -217,7 +271,8 @@ protected:
 		std::string payload;
 		ctemplate::ExpandTemplate(tfile, ctemplate::STRIP_WHITESPACE, dict, &payload);
 		*response << "Content-Length: " << payload.length() << "\r\n";
-		*response << "\r\n" << payload.c_str();
+		*response << "\r\n";
+		response->write( payload.data(), payload.length() );
 		DLOG(INFO) << "OK: " << payload;
 	}
 #endif
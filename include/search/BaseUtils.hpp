@@ -117,6 +117,36 @@ public:
 	*/
 	std::string StemWord(const std::string& input) const;
 
+	/**
+	* SetPartLimit: set max length of partial words indexed , needs reindex to change
+	*
+	* @param limit
+	*   size_t max length , 0 for all
+	*
+	* @return
+	*   none
+	*/
+	static void SetPartLimit(size_t limit);
+
+	/**
+	* GetPartLimit: get max length of partial words indexed
+	*
+	* @return
+	*   size_t max length , 0 for all
+	*/
+	static size_t GetPartLimit();
+
+	/**
+	* OverPartLimit: check if a partial word is too long to be indexed as part
+	*
+	* @param word
+	*   const std::string& word without prefix
+	*
+	* @return
+	*   bool true if it has to be matched by expanding full words
+	*/
+	static bool OverPartLimit(const std::string& word);
+
 protected:
 
 	/**
@@ -0,0 +1,203 @@
+/**
+ * @project zapdos
+ * @file include/search/CommitScheduler.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  CommitScheduler.hpp : Background batched commits for WriteIndex Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_COMMIT_SCHEDULER_HPP_
+#define _ZPDS_SEARCH_COMMIT_SCHEDULER_HPP_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+
+#include "utils/BaseUtils.hpp"
+#include "search/WriteIndex.hpp"
+
+#define XAP_COMMIT_DEFAULT_DOCS 10000
+#define XAP_COMMIT_DEFAULT_MS 5000
+#define XAP_COMMIT_DEFAULT_BYTES (64*1024*1024)
+#define XAP_COMMIT_DEFAULT_WAIT_MS 30000
+#define XAP_COMMIT_POLL_MS 100
+#define XAP_COMMIT_HIGH_WATER 2
+
+namespace zpds {
+namespace search {
+class CommitScheduler {
+
+public:
+
+	struct LimitsT {
+		uint64_t max_docs;
+		uint64_t max_ms;
+		uint64_t max_bytes;
+		uint64_t max_wait_ms;
+	};
+
+	using pointer = std::shared_ptr<CommitScheduler>;
+
+	/**
+	* Create : create CommitScheduler and start the thread
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer
+	*
+	* @param limits_
+	*   LimitsT limits , zero values take defaults
+	*
+	* @return
+	*   std::shared_ptr<CommitScheduler>
+	*
+	*/
+	static pointer Create(WriteIndex::pointer writer_, LimitsT limits_)
+	{
+		auto p = std::make_shared<CommitScheduler>(writer_, limits_);
+		p->Start();
+		return p;
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer
+	*
+	* @param limits_
+	*   LimitsT limits , zero values take defaults
+	*
+	*/
+	CommitScheduler(WriteIndex::pointer writer_, LimitsT limits_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	CommitScheduler() = delete;
+	CommitScheduler(const CommitScheduler&) = delete;
+	CommitScheduler& operator=(const CommitScheduler&) = delete;
+
+	/**
+	* destructor : stops the thread
+	*/
+	virtual ~CommitScheduler ();
+
+	/**
+	* Start : start the commit thread
+	*
+	* @return
+	*   none
+	*/
+	void Start();
+
+	/**
+	* Stop : stop the commit thread after a final commit
+	*
+	* @return
+	*   none
+	*/
+	void Stop();
+
+	/**
+	* Notify : wake the thread to check limits after changes
+	*
+	* @return
+	*   none
+	*/
+	void Notify();
+
+	/**
+	* RequestCommit : commit at the next wakeup regardless of limits
+	*
+	* @return
+	*   none
+	*/
+	void RequestCommit();
+
+	/**
+	* WaitForRoom : backpressure , blocks while pending changes are above high water
+	*
+	* @return
+	*   bool false if still above high water after max_wait_ms
+	*/
+	bool WaitForRoom();
+
+	/**
+	* GetCommits , GetWaits : counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetCommits() const;
+	uint64_t GetWaits() const;
+
+protected:
+	const WriteIndex::pointer writer;
+	const LimitsT limits;
+
+	std::mutex sched_lock;
+	std::condition_variable sched_cv;
+	std::condition_variable room_cv;
+	std::thread worker;
+	bool stopping;
+	bool requested;
+
+	std::atomic<uint64_t> commits;
+	std::atomic<uint64_t> waits;
+
+	/**
+	* Run : thread loop
+	*
+	* @return
+	*   none
+	*/
+	void Run();
+
+	/**
+	* IsDue : check if any limit is reached
+	*
+	* @return
+	*   bool
+	*/
+	bool IsDue() const;
+
+	/**
+	* IsFull : check if pending changes are above high water
+	*
+	* @return
+	*   bool
+	*/
+	bool IsFull() const;
+
+};
+
+} // namespace search
+} // namespace zpds
+
+#endif  // _ZPDS_SEARCH_COMMIT_SCHEDULER_HPP_
@@ -0,0 +1,227 @@
+/**
+ * @project zapdos
+ * @file include/search/DistanceSlabBatch.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  DistanceSlabBatch.hpp : Distance slab keys scored in batches over location columns
+ *
+ */
+#ifndef _ZPDS_SEARCH_DISTANCE_SLAB_BATCH_HPP_
+#define _ZPDS_SEARCH_DISTANCE_SLAB_BATCH_HPP_
+
+#include <vector>
+#include <xapian.h>
+
+#include "search/GeoColumn.hpp"
+#include "search/HaversineKernel.hpp"
+#include "search/DistanceSlabKeyMaker.hpp"
+
+#define XAP_DSLAB_BATCH 256
+#define XAP_DSLAB_BATCH_MAX_SLABS 4096
+// h closer than this to a slab edge is decided by the exact metric
+#define XAP_DSLAB_BATCH_TOL 1e-13
+
+namespace zpds {
+namespace search {
+
+/**
+* Collects matches as a match decider that rejects everything, scores them in blocks
+* with HaversineKernel and keeps the top items. Keys and order are the same as
+* sorting by DistanceSlabKeyMaker with ties in docid order.
+*
+*/
+class DistanceSlabBatch : public Xapian::MatchDecider {
+
+public:
+
+	struct ScoreT {
+		double key;
+		Xapian::docid did;
+	};
+	using ScoreVecT = std::vector<ScoreT>;
+
+	/**
+	* CanUse : check if slabs are few enough to score by threshold
+	*
+	*  @param slab_
+	*     int rounding value
+	*
+	*  @param md
+	*     int max distance
+	*
+	*  @return
+	*   bool
+	*/
+	static bool CanUse(int slab_, int md);
+
+	/**
+	* Constructor: default
+	*
+	*  @param centre_
+	*     const Xapian::LatLongCoord& centre
+	*
+	*  @param slab_
+	*     int rounding value
+	*
+	*  @param dd
+	*     int default distance
+	*
+	*  @param md
+	*     int max distance
+	*
+	*  @param column_
+	*     GeoColumn::pointer decoded values by docid
+	*
+	*  @param items_
+	*     size_t top items to keep
+	*
+	*/
+	DistanceSlabBatch(
+	    const Xapian::LatLongCoord& centre_,
+	    int slab_,
+	    int dd,
+	    int md,
+	    GeoColumn::pointer column_,
+	    size_t items_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	DistanceSlabBatch() = delete;
+	DistanceSlabBatch(const DistanceSlabBatch&) = delete;
+	DistanceSlabBatch& operator=(const DistanceSlabBatch&) = delete;
+
+	/**
+	* Destructor: default
+	*
+	*/
+	~DistanceSlabBatch();
+
+	/**
+	* operator(): collect , always rejects
+	*
+	*  @param doc
+	*   Xapian::Document&  doc
+	*
+	*  @return
+	*   bool false
+	*/
+	bool operator()(const Xapian::Document& doc) const override;
+
+	/**
+	* Finish: score pending and get top items by key then docid
+	*
+	*  @return
+	*   ScoreVecT
+	*/
+	ScoreVecT Finish();
+
+	/**
+	* Slab: distance slab of a point from its haversine term
+	*
+	*  @param h
+	*   double haversine term from HaversineKernel
+	*
+	*  @param row
+	*   const GeoColumn::RowT& row of the point
+	*
+	*  @return
+	*   int same as DistanceSlabKeyMaker
+	*/
+	int Slab(double h, const GeoColumn::RowT& row) const;
+
+	/**
+	* GetRefined: points decided by the exact metric
+	*
+	*  @return
+	*   size_t
+	*/
+	size_t GetRefined() const;
+
+protected:
+	const Xapian::LatLongCoord centre;
+	const int slab;
+	const int defdist;
+	const int maxdist;
+	const GeoColumn::pointer column;
+	const size_t items;
+	const HaversineKernel kernel;
+	const Xapian::GreatCircleMetric metric;
+	DistanceSlabKeyMaker keymaker;
+	std::vector<double> hslab;
+
+	// pending block , structure of arrays for the kernel
+	mutable std::vector<Xapian::docid> dids;
+	mutable std::vector<const GeoColumn::RowT*> rows;
+	mutable std::vector<double> sinlat;
+	mutable std::vector<double> coslat;
+	mutable std::vector<double> sinlon;
+	mutable std::vector<double> coslon;
+	mutable std::vector<double> hout;
+	mutable ScoreVecT heap;
+	mutable size_t refined;
+
+	/**
+	* Flush: score the pending block
+	*
+	*  @return
+	*   none
+	*/
+	void Flush() const;
+
+	/**
+	* Push: keep if in top items
+	*
+	*  @param key
+	*   double key
+	*
+	*  @param did
+	*   Xapian::docid did
+	*
+	*  @return
+	*   none
+	*/
+	void Push(double key, Xapian::docid did) const;
+
+	/**
+	* Key: key from distance and importance as DistanceSlabKeyMaker
+	*
+	*  @param dslab
+	*   int distance slab
+	*
+	*  @param importance
+	*   double importance
+	*
+	*  @return
+	*   double
+	*/
+	double Key(int dslab, double importance) const;
+
+};
+} // namespace search
+} // namespace zpds
+#endif // _ZPDS_SEARCH_DISTANCE_SLAB_BATCH_HPP_
@@ -34,6 +34,7 @@
 #define _ZPDS_SEARCH_DISTANCE_SLAB_KEYMAKER_HPP_
 
 #include <xapian.h>
+#include "search/GeoColumn.hpp"
 
 #define XAP_DSLAB_MAX_IMPORTANCE 100
 #define XAP_DSLAB_MAX_DISTANCE  400000
@@ -66,6 +67,9 @@ public:
 	*  @param md
 	*     int max distance
 	*
+	*  @param column_
+	*     GeoColumn::pointer decoded values by docid , used only for the default slots
+	*
 	*/
 	DistanceSlabKeyMaker(
 	    Xapian::valueno slot_,
@@ -73,7 +77,8 @@ public:
 	    const Xapian::LatLongCoords& centre_,
 	    int slab_,
 	    int dd= XAP_DSLAB_MAX_DISTANCE,
-	    int md= XAP_DSLAB_MAX_DISTANCE);
+	    int md= XAP_DSLAB_MAX_DISTANCE,
+	    GeoColumn::pointer column_= nullptr);
 
 	/**
 	* Destructor: default
@@ -100,6 +105,7 @@ protected:
 	int slab;
 	int defdist;
 	int maxdist;
+	GeoColumn::pointer column;
 
 };
 } // namespace search
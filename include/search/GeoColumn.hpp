@@ -0,0 +1,208 @@
+/**
+ * @project zapdos
+ * @file include/search/GeoColumn.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  GeoColumn.hpp : Docid indexed decoded location and importance columns
+ *
+ */
+#ifndef _ZPDS_SEARCH_GEO_COLUMN_HPP_
+#define _ZPDS_SEARCH_GEO_COLUMN_HPP_
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <xapian.h>
+
+#include "search/BaseUtils.hpp"
+
+#define XAP_GEOCOL_BLOCK 4096
+
+#define XAP_GEOCOL_UNKNOWN 0
+#define XAP_GEOCOL_NOLOC   1
+#define XAP_GEOCOL_POINT   2
+
+namespace zpds {
+namespace search {
+class GeoColumn {
+
+public:
+
+	// decoded XAP_LATLON_POS and XAP_IMPORTANCE_POS of one document , with sin and cos for HaversineKernel
+	struct RowT {
+		double lat = 0.0;
+		double lon = 0.0;
+		double importance = 0.0;
+		double sinlat = 0.0;
+		double coslat = 0.0;
+		double sinlon = 0.0;
+		double coslon = 0.0;
+		uint8_t state = XAP_GEOCOL_UNKNOWN;
+	};
+
+	// rows are kept in blocks so an update copies only the blocks it touches
+	using BlockT = std::array<RowT, XAP_GEOCOL_BLOCK>;
+	using BlockPtrT = std::shared_ptr<const BlockT>;
+	using BlockVecT = std::vector<BlockPtrT>;
+	using IdTermsT = std::vector<std::string>;
+
+	using pointer = std::shared_ptr<const GeoColumn>;
+
+	/**
+	* Build : build columns by streaming the values of all documents
+	*
+	* @param db
+	*   Xapian::Database& db
+	*
+	* @param generation
+	*   uint64_t commit generation of db
+	*
+	* @return
+	*   pointer
+	*/
+	static pointer Build(Xapian::Database& db, uint64_t generation);
+
+	/**
+	* Update : copy of prev with the rows of changed documents read again
+	*
+	* @param prev
+	*   const pointer& previous columns
+	*
+	* @param db
+	*   Xapian::Database& db
+	*
+	* @param generation
+	*   uint64_t commit generation of db
+	*
+	* @param idterms
+	*   const IdTermsT& idterms changed since prev
+	*
+	* @return
+	*   pointer
+	*/
+	static pointer Update(const pointer& prev, Xapian::Database& db, uint64_t generation, const IdTermsT& idterms);
+
+	/**
+	* ReadRow : decode a row from document values
+	*
+	* @param doc
+	*   const Xapian::Document& doc
+	*
+	* @return
+	*   RowT
+	*/
+	static RowT ReadRow(const Xapian::Document& doc);
+
+	/**
+	* SetPoint : set location of a row
+	*
+	* @param row
+	*   RowT& row
+	*
+	* @param lat
+	*   double latitude
+	*
+	* @param lon
+	*   double longitude
+	*
+	* @return
+	*   none
+	*/
+	static void SetPoint(RowT& row, double lat, double lon);
+
+	/**
+	* Constructor : default
+	*
+	* @param generation_
+	*   uint64_t commit generation
+	*
+	* @param blocks_
+	*   BlockVecT&& blocks moved
+	*
+	* @param rows_
+	*   size_t rows filled
+	*
+	*/
+	GeoColumn(uint64_t generation_, BlockVecT&& blocks_, size_t rows_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	GeoColumn() = delete;
+	GeoColumn(const GeoColumn&) = delete;
+	GeoColumn& operator=(const GeoColumn&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~GeoColumn ();
+
+	/**
+	* Find : row of a document if decoded
+	*
+	* @param did
+	*   Xapian::docid did
+	*
+	* @return
+	*   const RowT* nullptr if unknown
+	*/
+	inline const RowT* Find(Xapian::docid did) const
+	{
+		size_t b = did / XAP_GEOCOL_BLOCK;
+		if ( b >= blocks.size() || !blocks[b] ) return nullptr;
+		const RowT* row = &( (*blocks[b])[ did % XAP_GEOCOL_BLOCK ] );
+		return (row->state == XAP_GEOCOL_UNKNOWN) ? nullptr : row;
+	}
+
+	/**
+	* GetGeneration : commit generation of the columns
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetGeneration() const;
+
+	/**
+	* GetRows : rows decoded
+	*
+	* @return
+	*   size_t
+	*/
+	size_t GetRows() const;
+
+protected:
+	const uint64_t generation;
+	const BlockVecT blocks;
+	const size_t rows;
+
+};
+
+} // namespace search
+} // namespace zpds
+
+#endif  // _ZPDS_SEARCH_GEO_COLUMN_HPP_
@@ -47,6 +47,7 @@
 #define ZPDS_EARTH_RADIUS_KM 6371.0
 #define ZPDS_PI 3.14159265359
 #define ZPDS_LENGTH_OF_DEGREE  111100        // meters
+#define ZPDS_GEOHASH_SAFE_RATIO 0.999        // shrink computed radius for rounding
 
 #define ZPDS_DEFAULT_MIN_LAT -90.0
 #define ZPDS_DEFAULT_MAX_LAT  90.0
@@ -172,6 +173,29 @@ public:
 	*/
 	double DistanceKm(double lat1, double lon1, double lat2, double lon2) const;
 
+	/**
+	* InnerRadiusM: min distance in meters from a point inside hash to the edge of the
+	*   block made of hash and its neighbours upto level, a point outside the block is
+	*   at least this far. Returns 0 if the block is too close to the world borders for
+	*   the indexed neighbour terms to be complete.
+	*
+	* @param lat
+	*   double degrees
+	*
+	* @param lon
+	*   double degrees
+	*
+	* @param hash
+	*   std::string hash containing the point
+	*
+	* @param level
+	*   size_t level of neighbour
+	*
+	* @return
+	*   double meters
+	*/
+	double InnerRadiusM(double lat, double lon, std::string hash, size_t level) const;
+
 	/**
 	* GetOneNeighbour : get neighbour in one dir
 	*
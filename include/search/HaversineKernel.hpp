@@ -0,0 +1,169 @@
+/**
+ * @project zapdos
+ * @file include/search/HaversineKernel.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  HaversineKernel.hpp : Batch haversine terms with simd dispatch
+ *
+ */
+#ifndef _ZPDS_SEARCH_HAVERSINE_KERNEL_HPP_
+#define _ZPDS_SEARCH_HAVERSINE_KERNEL_HPP_
+
+#include <cstddef>
+#include <string>
+
+// same radius as Xapian::GreatCircleMetric default
+#define XAP_DKERNEL_RADIUS 6378137.0
+#define XAP_DKERNEL_DEG2RAD (3.14159265358979323846 / 180.0)
+
+namespace zpds {
+namespace search {
+class HaversineKernel {
+
+public:
+
+	enum IsaE {
+		ISA_SCALAR = 0,
+		ISA_SSE4 = 1,
+		ISA_AVX2 = 2
+	};
+
+	/**
+	* Constructor : default , picks the widest isa this cpu has
+	*
+	* @param lat
+	*   double latitude of centre in degrees
+	*
+	* @param lon
+	*   double longitude of centre in degrees
+	*
+	*/
+	HaversineKernel(double lat, double lon);
+
+	/**
+	* Constructor : with isa , falls back to scalar if not supported
+	*
+	* @param lat
+	*   double latitude of centre in degrees
+	*
+	* @param lon
+	*   double longitude of centre in degrees
+	*
+	* @param isa_
+	*   IsaE isa
+	*
+	*/
+	HaversineKernel(double lat, double lon, IsaE isa_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	HaversineKernel() = delete;
+	HaversineKernel(const HaversineKernel&) = delete;
+	HaversineKernel& operator=(const HaversineKernel&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~HaversineKernel ();
+
+	/**
+	* Haversine : haversine term h of n points from their sin and cos , no trig per point.
+	*   distance is 2 * radius * asin(sqrt(h)) , h is monotonic in distance
+	*
+	* @param sinlat
+	*   const double* sin of latitudes
+	*
+	* @param coslat
+	*   const double* cos of latitudes
+	*
+	* @param sinlon
+	*   const double* sin of longitudes
+	*
+	* @param coslon
+	*   const double* cos of longitudes
+	*
+	* @param n
+	*   size_t points
+	*
+	* @param out
+	*   double* h of each point
+	*
+	* @return
+	*   none
+	*/
+	void Haversine(const double* sinlat, const double* coslat, const double* sinlon, const double* coslon,
+	               size_t n, double* out) const;
+
+	/**
+	* GetIsa : isa in use
+	*
+	* @return
+	*   IsaE
+	*/
+	IsaE GetIsa() const;
+
+	/**
+	* GetIsaName : isa in use as string
+	*
+	* @return
+	*   std::string
+	*/
+	std::string GetIsaName() const;
+
+	/**
+	* BestIsa : widest isa this cpu has
+	*
+	* @return
+	*   IsaE
+	*/
+	static IsaE BestIsa();
+
+	/**
+	* ToH : haversine term for a distance in meters
+	*
+	* @param dist
+	*   double distance in meters
+	*
+	* @return
+	*   double h
+	*/
+	static double ToH(double dist);
+
+protected:
+	IsaE isa;
+	double sinlat;
+	double coslat;
+	double sinlon;
+	double coslon;
+
+};
+
+} // namespace search
+} // namespace zpds
+
+#endif  // _ZPDS_SEARCH_HAVERSINE_KERNEL_HPP_
@@ -82,8 +82,6 @@ public:
 	*/
 	void DelRecord(::zpds::utils::SharedTable::pointer stptr, ::zpds::store::ItemDataT* record) const;
 
-protected:
-
 	/**
 	* GetIndexType : get the index type
 	*
@@ -93,7 +91,7 @@ protected:
 	virtual IndexTypeE GetIndexType() const=0;
 
 	/**
-	* CreateDoc : create a new doc using ItemDataT
+	* CreateDoc : create a new doc using ItemDataT , public for the index pipeline
 	*
 	* @param params
 	*   ::zpds::store::ItemDataT* record
@@ -103,6 +101,8 @@ protected:
 	*/
 	virtual Xapian::Document CreateDoc(::zpds::store::ItemDataT* record) const=0;
 
+protected:
+
 	/**
 	* IndexFullWords : index items without part
 	*
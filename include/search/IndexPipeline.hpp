@@ -0,0 +1,301 @@
+/**
+ * @project zapdos
+ * @file include/search/IndexPipeline.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  IndexPipeline.hpp : Asynchronous indexing of committed transactions Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_INDEX_PIPELINE_HPP_
+#define _ZPDS_SEARCH_INDEX_PIPELINE_HPP_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <condition_variable>
+#include <xapian.h>
+
+#include "utils/BaseUtils.hpp"
+#include "search/WriteIndex.hpp"
+#include "search/CommitScheduler.hpp"
+#include "../proto/Store.pb.h"
+
+#define XAP_INDEX_DEFAULT_THREADS 2
+#define XAP_INDEX_DEFAULT_QUEUE 1024
+// a log id not seen this long is taken as lost , every committed or failed id is pushed
+#define XAP_INDEX_GAP_MS 30000
+// a given up log id arriving later than this is dropped , not checked against newer changes
+#define XAP_INDEX_SKIP_KEEP_MS 300000
+
+namespace zpds {
+namespace search {
+class IndexPipeline {
+
+public:
+
+	// one index change ready to be written
+	struct OpT {
+		::zpds::search::LangTypeE lang;
+		::zpds::search::IndexTypeE dtyp;
+		std::string idterm;
+		bool to_del;
+		Xapian::Document doc;
+	};
+
+	using OpListT = std::vector<OpT>;
+	using ReadyMapT = std::map<uint64_t, OpListT>;
+	using JobQueueT = std::deque<::zpds::store::TransactionT>;
+
+	using pointer = std::shared_ptr<IndexPipeline>;
+
+	/**
+	* Create : create IndexPipeline and start the threads
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer
+	*
+	* @param sched_
+	*   CommitScheduler::pointer scheduler to notify , can be null
+	*
+	* @param threads_
+	*   size_t document builder threads
+	*
+	* @param capacity_
+	*   size_t max transactions waiting
+	*
+	* @return
+	*   std::shared_ptr<IndexPipeline>
+	*
+	*/
+	static pointer Create(WriteIndex::pointer writer_, CommitScheduler::pointer sched_, size_t threads_, size_t capacity_)
+	{
+		auto p = std::make_shared<IndexPipeline>(writer_, sched_, threads_, capacity_);
+		p->Start();
+		return p;
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer
+	*
+	* @param sched_
+	*   CommitScheduler::pointer scheduler to notify , can be null
+	*
+	* @param threads_
+	*   size_t document builder threads , zero takes default
+	*
+	* @param capacity_
+	*   size_t max transactions waiting , zero takes default
+	*
+	*/
+	IndexPipeline(WriteIndex::pointer writer_, CommitScheduler::pointer sched_, size_t threads_, size_t capacity_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	IndexPipeline() = delete;
+	IndexPipeline(const IndexPipeline&) = delete;
+	IndexPipeline& operator=(const IndexPipeline&) = delete;
+
+	/**
+	* destructor : stops the threads
+	*/
+	virtual ~IndexPipeline ();
+
+	/**
+	* Start : start builder and writer threads
+	*
+	* @return
+	*   none
+	*/
+	void Start();
+
+	/**
+	* Stop : drain the queue and stop the threads
+	*
+	* @return
+	*   none
+	*/
+	void Stop();
+
+	/**
+	* Push : queue a committed transaction , blocks while the queue is full
+	*
+	* @param trans
+	*   ::zpds::store::TransactionT&& trans moved , only index items needed
+	*
+	* @return
+	*   bool false if stopped , caller should index directly
+	*/
+	bool Push(::zpds::store::TransactionT&& trans);
+
+	/**
+	* Skip : log id that will never be pushed , like a failed commit , so later ones can go
+	*
+	* @param logid
+	*   uint64_t log id
+	*
+	* @return
+	*   none
+	*/
+	void Skip(uint64_t logid);
+
+	/**
+	* SetWatermark : last log id already in the index , ids after it are applied in order
+	*   nothing is applied till this is called
+	*
+	* @param logid
+	*   uint64_t last log id at start
+	*
+	* @return
+	*   none
+	*/
+	void SetWatermark(uint64_t logid);
+
+	/**
+	* CommitAfter : request an index commit once this log id is written
+	*
+	* @param logid
+	*   uint64_t log id
+	*
+	* @return
+	*   none
+	*/
+	void CommitAfter(uint64_t logid);
+
+	/**
+	* Flush : wait till log ids upto this are written to the index
+	*
+	* @param logid
+	*   uint64_t log id , usually logcounter at the time of call
+	*
+	* @param max_wait_ms
+	*   uint64_t max wait in ms
+	*
+	* @return
+	*   bool false on timeout
+	*/
+	bool Flush(uint64_t logid, uint64_t max_wait_ms);
+
+	/**
+	* GetLastIndexed : log id of last transaction written
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetLastIndexed() const;
+
+	/**
+	* GetInflight , GetGaps : counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetInflight() const;
+	uint64_t GetGaps() const;
+
+protected:
+	const WriteIndex::pointer writer;
+	const CommitScheduler::pointer sched;
+	const size_t threads;
+	const size_t capacity;
+
+	std::mutex job_lock;
+	std::condition_variable job_cv;
+	std::condition_variable room_cv;
+	JobQueueT jobs;
+	bool stopping;
+	std::vector<std::thread> builders;
+
+	std::mutex ready_lock;
+	std::condition_variable ready_cv;
+	std::condition_variable idle_cv;
+	ReadyMapT ready;
+	bool finishing;
+	bool seeded;
+	uint64_t next_id;
+	// ids given up on with time , docs written since , a late one does not overwrite a newer change
+	std::map<uint64_t, uint64_t> skipped;
+	std::unordered_map<std::string, uint64_t> touched;
+	std::thread applier;
+
+	std::atomic<uint64_t> inflight;
+	std::atomic<uint64_t> last_indexed;
+	std::atomic<uint64_t> gaps;
+	std::atomic<uint64_t> commit_at;
+
+	/**
+	* Build : builder thread loop , creates documents in parallel
+	*
+	* @return
+	*   none
+	*/
+	void Build();
+
+	/**
+	* Apply : writer thread loop , writes in log id order
+	*
+	* @return
+	*   none
+	*/
+	void Apply();
+
+	/**
+	* MakeOps : create index changes for a transaction
+	*
+	* @param trans
+	*   ::zpds::store::TransactionT* trans
+	*
+	* @return
+	*   OpListT
+	*/
+	OpListT MakeOps(::zpds::store::TransactionT* trans) const;
+
+	/**
+	* RunCommit : commit if requested upto logid , once
+	*
+	* @param logid
+	*   uint64_t log id written
+	*
+	* @return
+	*   none
+	*/
+	void RunCommit(uint64_t logid);
+
+};
+
+} // namespace search
+} // namespace zpds
+
+#endif  // _ZPDS_SEARCH_INDEX_PIPELINE_HPP_
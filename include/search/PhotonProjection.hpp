@@ -0,0 +1,98 @@
+/**
+ * @project zapdos
+ * @file include/search/PhotonProjection.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PhotonProjection.hpp : Photon projection stored as document data Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_PHOTON_PROJECTION_HPP_
+#define _ZPDS_SEARCH_PHOTON_PROJECTION_HPP_
+
+#include <string>
+#include <xapian.h>
+
+#include "../proto/Search.pb.h"
+#include "../proto/Store.pb.h"
+
+// first byte of document data , bump if the stored projection changes
+#define XAP_PHOTON_DATA_MARK 'P'
+
+namespace zpds {
+namespace search {
+class PhotonProjection {
+
+public:
+
+	/**
+	* Make : fill the photon feature served for a record
+	*
+	* @param record
+	*   const ::zpds::store::ItemDataT* record
+	*
+	* @param feat
+	*   PhotonDataT* feature to fill
+	*
+	* @return
+	*   none
+	*/
+	static void Make(const ::zpds::store::ItemDataT* record, PhotonDataT* feat);
+
+	/**
+	* Serialize : projection of a record to keep as document data
+	*
+	* @param record
+	*   const ::zpds::store::ItemDataT* record
+	*
+	* @return
+	*   std::string
+	*/
+	static std::string Serialize(const ::zpds::store::ItemDataT* record);
+
+	/**
+	* Load : read the projection of a record from the index
+	*
+	* @param db
+	*   const Xapian::Database& db
+	*
+	* @param id
+	*   uint64_t record id
+	*
+	* @param feat
+	*   PhotonDataT* feature to fill
+	*
+	* @return
+	*   bool false if not in index or indexed without projection
+	*/
+	static bool Load(const Xapian::Database& db, uint64_t id, PhotonDataT* feat);
+
+};
+
+} // namespace search
+} // namespace zpds
+#endif  // _ZPDS_SEARCH_PHOTON_PROJECTION_HPP_
+
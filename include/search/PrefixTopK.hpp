@@ -0,0 +1,252 @@
+/**
+ * @project zapdos
+ * @file include/search/PrefixTopK.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PrefixTopK.hpp : Top documents by importance for short partial word prefixes
+ *
+ */
+#ifndef _ZPDS_SEARCH_PREFIX_TOPK_HPP_
+#define _ZPDS_SEARCH_PREFIX_TOPK_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <xapian.h>
+
+#include "search/BaseUtils.hpp"
+
+#define XAP_PREFIX_ITEMS 10
+#define XAP_PREFIX_MAX_DEPTH 8
+#define XAP_PREFIX_SEP " "
+
+namespace zpds {
+namespace search {
+
+/**
+* Nodes of a trie over partial word terms upto a few characters , each with the top
+* documents by importance for the terms a one word partial query of that prefix needs ,
+* optionally also per geohash3 cell. Nodes are kept by their terms so a query is one
+* lookup. Order and keys are the same as sorting on XAP_IMPORTANCE_POS in reverse.
+*
+*/
+class PrefixTopK {
+
+public:
+
+	struct ParamsT {
+		size_t depth = 0;
+		size_t items = XAP_PREFIX_ITEMS;
+		bool geo = false;
+	};
+
+	struct EntryT {
+		std::string key;
+		Xapian::docid did;
+		uint64_t id;
+	};
+	using EntryVecT = std::vector<EntryT>;
+	using BucketMapT = std::unordered_map<std::string, EntryVecT>;
+
+	struct NodeT {
+		EntryVecT top;
+		BucketMapT buckets;
+	};
+	using NodeMapT = std::unordered_map<std::string, NodeT>;
+
+	using WordVecT = BaseUtils::WordVecT;
+	using IdTermsT = std::vector<std::string>;
+
+	using pointer = std::shared_ptr<const PrefixTopK>;
+
+	/**
+	* Build : build all nodes by walking postings of short partial terms
+	*
+	* @param db
+	*   Xapian::Database& db
+	*
+	* @param generation
+	*   uint64_t commit generation of db
+	*
+	* @param params
+	*   const ParamsT& params
+	*
+	* @return
+	*   pointer
+	*/
+	static pointer Build(Xapian::Database& db, uint64_t generation, const ParamsT& params);
+
+	/**
+	* Update : copy of prev with changed documents taken out and put back as now ,
+	*   nodes that lose one of a full list are walked again
+	*
+	* @param prev
+	*   const pointer& previous
+	*
+	* @param db
+	*   Xapian::Database& db
+	*
+	* @param generation
+	*   uint64_t commit generation of db
+	*
+	* @param idterms
+	*   const IdTermsT& idterms changed since prev
+	*
+	* @return
+	*   pointer
+	*/
+	static pointer Update(const pointer& prev, Xapian::Database& db, uint64_t generation, const IdTermsT& idterms);
+
+	/**
+	* Find : top items for query terms if this can answer them exactly
+	*
+	* @param terms
+	*   const WordVecT& terms all needed , as GetQueryTerms
+	*
+	* @param items
+	*   size_t items needed
+	*
+	* @param out
+	*   EntryVecT& output
+	*
+	* @return
+	*   bool false if the query must go to the index
+	*/
+	bool Find(const WordVecT& terms, size_t items, EntryVecT& out) const;
+
+	/**
+	* GetGeneration : commit generation
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetGeneration() const;
+
+	/**
+	* GetNodes : no of nodes
+	*
+	* @return
+	*   size_t
+	*/
+	size_t GetNodes() const;
+
+	/**
+	* Constructor : from nodes
+	*
+	* @param generation_
+	*   uint64_t commit generation
+	*
+	* @param params_
+	*   const ParamsT& params
+	*
+	* @param nodes_
+	*   NodeMapT&& nodes moved
+	*
+	*/
+	PrefixTopK(uint64_t generation_, const ParamsT& params_, NodeMapT&& nodes_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	PrefixTopK() = delete;
+	PrefixTopK(const PrefixTopK&) = delete;
+	PrefixTopK& operator=(const PrefixTopK&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~PrefixTopK ();
+
+protected:
+	const uint64_t generation;
+	const ParamsT params;
+	const NodeMapT nodes;
+
+	/**
+	* Scan : walk postings of the terms of a node
+	*
+	* @param db
+	*   Xapian::Database& db
+	*
+	* @param terms
+	*   const WordVecT& terms of node , the first is walked
+	*
+	* @param params
+	*   const ParamsT& params
+	*
+	* @return
+	*   NodeT
+	*/
+	static NodeT Scan(Xapian::Database& db, const WordVecT& terms, const ParamsT& params);
+
+	/**
+	* Insert : keep entry if in top items
+	*
+	* @param list
+	*   EntryVecT& list sorted
+	*
+	* @param entry
+	*   const EntryT& entry
+	*
+	* @param items
+	*   size_t items to keep
+	*
+	* @return
+	*   bool if kept
+	*/
+	static bool Insert(EntryVecT& list, const EntryT& entry, size_t items);
+
+	/**
+	* NodeTerms : terms of nodes a partial term is walked for
+	*
+	* @param walk
+	*   const std::string& walked term
+	*
+	* @param depth
+	*   size_t max prefix length
+	*
+	* @return
+	*   std::vector<WordVecT> terms per node , empty if none
+	*/
+	static std::vector<WordVecT> NodeTerms(const std::string& walk, size_t depth);
+
+	/**
+	* Bucket : geohash3 cell as indexed for a location value
+	*
+	* @param value
+	*   const std::string& serialised coords
+	*
+	* @return
+	*   std::string empty if none
+	*/
+	static std::string Bucket(const std::string& value);
+
+};
+} // namespace search
+} // namespace zpds
+#endif // _ZPDS_SEARCH_PREFIX_TOPK_HPP_
@@ -40,6 +40,7 @@
 #include <xapian.h>
 
 #include "utils/BaseUtils.hpp"
+#include "search/ReaderPool.hpp"
 #include "../proto/Search.pb.h"
 
 namespace zpds {
@@ -49,6 +50,8 @@ class ReadIndex {
 public:
 	using DatabaseT = Xapian::Database;
 	using TrieMapT = std::unordered_map< int, DatabaseT >;
+	using LeaseMapT = std::unordered_map< int, ReaderPool::HandleT >;
+	using ToolMapT = std::unordered_map< int, ReaderPool::ToolsPtrT >;
 
 	using pointer = std::shared_ptr<ReadIndex>;
 
@@ -76,6 +79,15 @@ public:
 	*/
 	ReadIndex(std::string dbpath_);
 
+	/**
+	* Constructor : with pool , handles are leased and returned on destruction
+	*
+	* @param pool_
+	*   ReaderPool::pointer pool
+	*
+	*/
+	ReadIndex(ReaderPool::pointer pool_);
+
 	/**
 	* make noncopyable and remove default
 	*/
@@ -102,9 +114,54 @@ public:
 	*/
 	DatabaseT& Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
 
+	/**
+	* GetTools: enquire bound to the handle got by Get , sort reset to relevance
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   ReaderPool::ToolsT&
+	*/
+	ReaderPool::ToolsT& GetTools(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+	/**
+	* GetGeoColumn: decoded location columns for the handle got by Get , pool only
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   GeoColumn::pointer nullptr if none
+	*/
+	GeoColumn::pointer GetGeoColumn(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+	/**
+	* GetPrefixTopK: top documents of short prefixes for the handle got by Get , pool only
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   PrefixTopK::pointer nullptr if none
+	*/
+	PrefixTopK::pointer GetPrefixTopK(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
 protected:
 	const std::string dbpath;
 	TrieMapT triemap;
+	ReaderPool::pointer pool;
+	LeaseMapT leasemap;
+	ToolMapT toolmap;
 
 };
 
@@ -0,0 +1,408 @@
+/**
+ * @project zapdos
+ * @file include/search/ReaderPool.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ReaderPool.hpp : Shared pool of Xapian read handles Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_READER_POOL_HPP_
+#define _ZPDS_SEARCH_READER_POOL_HPP_
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <set>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <xapian.h>
+
+#include "utils/BaseUtils.hpp"
+#include "search/WriteIndex.hpp"
+#include "search/GeoColumn.hpp"
+#include "search/PrefixTopK.hpp"
+#include "../proto/Search.pb.h"
+
+#define ZPDS_READER_POOL_MAX_IDLE 16
+
+namespace zpds {
+namespace search {
+class ReaderPool {
+
+public:
+	using DatabaseT = Xapian::Database;
+	using DbPtrT = std::shared_ptr<DatabaseT>;
+
+	// query objects bound to a handle , reused by every lease of it
+	struct ToolsT {
+		Xapian::Enquire enquire;
+		ToolsT(const DatabaseT& db);
+	};
+	using ToolsPtrT = std::shared_ptr<ToolsT>;
+
+	struct HandleT {
+		DbPtrT db;
+		uint64_t generation;
+		ToolsPtrT tools;
+	};
+
+	using FreeListT = std::vector<HandleT>;
+	using FreeMapT = std::unordered_map< int, FreeListT >;
+	using ColumnMapT = std::unordered_map< int, GeoColumn::pointer >;
+	using PrefixMapT = std::unordered_map< int, PrefixTopK::pointer >;
+
+	using pointer = std::shared_ptr<ReaderPool>;
+
+	/**
+	* Create : create ReaderPool
+	*
+	* @param dbpath_
+	*   std::string dbpath
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer for commit generation, can be null
+	*
+	* @param max_idle_
+	*   size_t max idle handles kept per index
+	*
+	* @param geo_column_
+	*   bool keep decoded location columns per index
+	*
+	* @param prefix_
+	*   PrefixTopK::ParamsT top documents of short prefixes per index , off if depth is 0
+	*
+	* @return
+	*   std::shared_ptr<ReaderPool>
+	*
+	*/
+	static pointer Create(std::string dbpath_, WriteIndex::pointer writer_,
+	                      size_t max_idle_=ZPDS_READER_POOL_MAX_IDLE, bool geo_column_=false,
+	                      PrefixTopK::ParamsT prefix_=PrefixTopK::ParamsT())
+	{
+		return std::make_shared<ReaderPool>(std::move(dbpath_), writer_, max_idle_, geo_column_, prefix_);
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param dbpath_
+	*   std::string dbpath
+	*
+	* @param writer_
+	*   WriteIndex::pointer writer for commit generation, can be null
+	*
+	* @param max_idle_
+	*   size_t max idle handles kept per index
+	*
+	* @param geo_column_
+	*   bool keep decoded location columns per index
+	*
+	* @param prefix_
+	*   PrefixTopK::ParamsT top documents of short prefixes per index , off if depth is 0
+	*
+	*/
+	ReaderPool(std::string dbpath_, WriteIndex::pointer writer_, size_t max_idle_, bool geo_column_=false,
+	           PrefixTopK::ParamsT prefix_=PrefixTopK::ParamsT());
+
+	/**
+	* make noncopyable and remove default
+	*/
+	ReaderPool() = delete;
+	ReaderPool(const ReaderPool&) = delete;
+	ReaderPool& operator=(const ReaderPool&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~ReaderPool ();
+
+	/**
+	* Lease: get an exclusive handle, reopened if the index has been committed since
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   HandleT
+	*/
+	HandleT Lease(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+	/**
+	* Release: return a leased handle to the pool
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param handle
+	*   HandleT&& handle moved
+	*
+	* @return
+	*   none
+	*/
+	void Release(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, HandleT&& handle);
+
+	/**
+	* GetGeoColumn: decoded location columns matching a leased handle
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param handle
+	*   const HandleT& leased handle
+	*
+	* @return
+	*   GeoColumn::pointer nullptr if not built for this generation , a refresh is then queued
+	*/
+	GeoColumn::pointer GetGeoColumn(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const HandleT& handle);
+
+	/**
+	* GetColumnBuilds , GetColumnUpdates , GetColumnRows : location column counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetColumnBuilds() const;
+	uint64_t GetColumnUpdates() const;
+	uint64_t GetColumnRows();
+
+	/**
+	* GetPrefixTopK: top documents of short prefixes matching a leased handle
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param handle
+	*   const HandleT& leased handle
+	*
+	* @return
+	*   PrefixTopK::pointer nullptr if not built for this generation , a refresh is then queued
+	*/
+	PrefixTopK::pointer GetPrefixTopK(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const HandleT& handle);
+
+	/**
+	* GetPrefixBuilds , GetPrefixUpdates , GetPrefixNodes : prefix top documents counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetPrefixBuilds() const;
+	uint64_t GetPrefixUpdates() const;
+	uint64_t GetPrefixNodes();
+
+	/**
+	* GetPath: get the base path
+	*
+	* @return
+	*   const std::string&
+	*/
+	const std::string& GetPath() const;
+
+	/**
+	* GetHits , GetMisses , GetReopens : counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetHits() const;
+	uint64_t GetMisses() const;
+	uint64_t GetReopens() const;
+
+	/**
+	* GetLastLag , GetMaxLag : freshness lag in ms between a commit and the first reader seeing it
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetLastLag() const;
+	uint64_t GetMaxLag() const;
+
+	/**
+	* OpenUnion: open all shards of an index as one database
+	*
+	* @param dbpath
+	*   const std::string& base path
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   DatabaseT
+	*/
+	static DatabaseT OpenUnion(const std::string& dbpath, ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+protected:
+	const std::string dbpath;
+	const WriteIndex::pointer writer;
+	const size_t max_idle;
+	const bool geo_column;
+
+	std::mutex pool_lock;
+	FreeMapT freemap;
+
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> reopens;
+	std::atomic<uint64_t> seen_generation;
+	std::atomic<uint64_t> last_lag;
+	std::atomic<uint64_t> max_lag;
+
+	std::mutex column_lock;
+	ColumnMapT columns;
+	std::atomic<uint64_t> column_builds;
+	std::atomic<uint64_t> column_updates;
+
+	const PrefixTopK::ParamsT prefix_params;
+	std::mutex prefix_lock;
+	PrefixMapT prefixes;
+	std::atomic<uint64_t> prefix_builds;
+	std::atomic<uint64_t> prefix_updates;
+
+	// columns and prefix tries are built or updated by this thread only , never on a lease
+	std::mutex refresh_lock;
+	std::condition_variable refresh_cv;
+	std::set<int> pending;
+	bool refresh_stop;
+	std::thread refresher;
+
+	/**
+	* Snapshot: current commit snapshot of writer
+	*
+	* @return
+	*   WriteIndex::SnapshotPtrT
+	*/
+	WriteIndex::SnapshotPtrT Snapshot() const;
+
+	/**
+	* UpdateLag: record freshness lag once per generation
+	*
+	* @param snap
+	*   const WriteIndex::SnapshotPtrT& snapshot seen
+	*
+	* @return
+	*   none
+	*/
+	void UpdateLag(const WriteIndex::SnapshotPtrT& snap);
+
+	/**
+	* RequestRefresh: queue a refresh of columns for an index , does not wait
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   none
+	*/
+	void RequestRefresh(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+	/**
+	* RefreshLoop: refresher thread loop , opens its own handles at the latest generation
+	*
+	* @return
+	*   none
+	*/
+	void RefreshLoop();
+
+	/**
+	* RefreshColumn: bring the location columns upto a generation , refresher thread only
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param db
+	*   DatabaseT& handle opened at this generation
+	*
+	* @param generation
+	*   uint64_t generation
+	*
+	* @return
+	*   none
+	*/
+	void RefreshColumn(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, DatabaseT& db, uint64_t generation);
+
+	/**
+	* RefreshPrefix: bring the prefix top documents upto a generation , refresher thread only
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param db
+	*   DatabaseT& handle opened at this generation
+	*
+	* @param generation
+	*   uint64_t generation
+	*
+	* @return
+	*   none
+	*/
+	void RefreshPrefix(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, DatabaseT& db, uint64_t generation);
+
+	/**
+	* Open: open a new handle
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @return
+	*   DbPtrT
+	*/
+	DbPtrT Open(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+
+};
+
+} // namespace search
+} // namespace zpds
+
+#endif  // _ZPDS_SEARCH_READER_POOL_HPP_
@@ -0,0 +1,299 @@
+/**
+ * @project zapdos
+ * @file include/search/ResultCache.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ResultCache.hpp : Sharded bounded cache of completion results Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_RESULT_CACHE_HPP_
+#define _ZPDS_SEARCH_RESULT_CACHE_HPP_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <list>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "utils/BaseUtils.hpp"
+
+#define XAP_RESULT_CACHE_SHARDS 16
+#define XAP_RESULT_CACHE_TTL_MS 60000
+// approx bytes used by an entry apart from key and ids
+#define XAP_RESULT_CACHE_OVERHEAD 128
+// sketch counters per shard per expected entry , and expected entry size
+#define XAP_RESULT_SKETCH_RATIO 2
+#define XAP_RESULT_SKETCH_ENTRY 512
+#define XAP_RESULT_SKETCH_MIN 1024
+#define XAP_RESULT_SKETCH_ROWS 4
+#define XAP_RESULT_SKETCH_MAX_COUNT 15
+
+namespace zpds {
+namespace search {
+
+/**
+* Completion result ids by key , each shard an lru list bounded by bytes. Entries are
+* stale once the commit generation moves or ttl passes. A new key displaces the least
+* recently used only if asked for more often recently , counted in a count min sketch
+* that is halved periodically ( tinylfu ).
+*
+*/
+class ResultCache {
+
+public:
+	using IdVecT = std::vector<uint64_t>;
+	using pointer = std::shared_ptr<ResultCache>;
+
+	/**
+	* Create : create ResultCache
+	*
+	* @param max_bytes_
+	*   uint64_t max bytes of all entries
+	*
+	* @param ttl_ms_
+	*   uint64_t max age of entry in ms
+	*
+	* @param shards_
+	*   size_t no of shards
+	*
+	* @return
+	*   std::shared_ptr<ResultCache>
+	*
+	*/
+	static pointer Create(uint64_t max_bytes_, uint64_t ttl_ms_=XAP_RESULT_CACHE_TTL_MS, size_t shards_=XAP_RESULT_CACHE_SHARDS)
+	{
+		return std::make_shared<ResultCache>(max_bytes_, ttl_ms_, shards_);
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param max_bytes_
+	*   uint64_t max bytes of all entries
+	*
+	* @param ttl_ms_
+	*   uint64_t max age of entry in ms
+	*
+	* @param shards_
+	*   size_t no of shards
+	*
+	*/
+	ResultCache(uint64_t max_bytes_, uint64_t ttl_ms_, size_t shards_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	ResultCache() = delete;
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~ResultCache ();
+
+	/**
+	* Get: get ids if fresh
+	*
+	* @param key
+	*   const std::string& key
+	*
+	* @param generation
+	*   uint64_t current commit generation
+	*
+	* @param ids
+	*   IdVecT& ids to fill
+	*
+	* @return
+	*   bool if found
+	*/
+	bool Get(const std::string& key, uint64_t generation, IdVecT& ids);
+
+	/**
+	* Put: add ids if admitted
+	*
+	* @param key
+	*   const std::string& key
+	*
+	* @param generation
+	*   uint64_t commit generation the ids were searched at
+	*
+	* @param ids
+	*   const IdVecT& ids
+	*
+	* @return
+	*   bool if added
+	*/
+	bool Put(const std::string& key, uint64_t generation, const IdVecT& ids);
+
+	/**
+	* GetHits : lookups found
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetHits() const;
+
+	/**
+	* GetMisses : lookups not found or stale
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetMisses() const;
+
+	/**
+	* GetRejects : new entries not admitted
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetRejects() const;
+
+	/**
+	* GetEvictions : entries removed for space
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetEvictions() const;
+
+	/**
+	* GetBytes : approx bytes used
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetBytes() const;
+
+	/**
+	* GetEntries : entries held
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetEntries() const;
+
+protected:
+
+	struct EntryT {
+		std::string key;
+		uint64_t generation;
+		uint64_t expires;
+		IdVecT ids;
+		size_t bytes;
+	};
+
+	using ListT = std::list<EntryT>;
+	using IndexT = std::unordered_map<std::string, ListT::iterator>;
+
+	struct ShardT {
+		std::mutex lock;
+		ListT lru;
+		IndexT index;
+		size_t bytes;
+		std::vector<uint8_t> sketch;
+		size_t additions;
+	};
+
+	const uint64_t ttl_ms;
+	const size_t shard_bytes;
+	size_t sketch_width;
+	std::vector<std::unique_ptr<ShardT> > shards;
+
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> rejects;
+	std::atomic<uint64_t> evictions;
+	std::atomic<uint64_t> bytes;
+	std::atomic<uint64_t> entries;
+
+	/**
+	* Touch : count an access in sketch , shard lock held
+	*
+	* @param shard
+	*   ShardT& shard
+	*
+	* @param hash
+	*   size_t hash of key
+	*
+	* @return
+	*   none
+	*/
+	void Touch(ShardT& shard, size_t hash);
+
+	/**
+	* Frequency : estimated recent accesses , shard lock held
+	*
+	* @param shard
+	*   ShardT& shard
+	*
+	* @param hash
+	*   size_t hash of key
+	*
+	* @return
+	*   uint8_t
+	*/
+	uint8_t Frequency(ShardT& shard, size_t hash) const;
+
+	/**
+	* Remove : remove an entry , shard lock held
+	*
+	* @param shard
+	*   ShardT& shard
+	*
+	* @param it
+	*   ListT::iterator entry
+	*
+	* @return
+	*   none
+	*/
+	void Remove(ShardT& shard, ListT::iterator it);
+
+	/**
+	* Stale : check if entry is stale
+	*
+	* @param entry
+	*   const EntryT& entry
+	*
+	* @param generation
+	*   uint64_t current generation
+	*
+	* @param now
+	*   uint64_t current time ms
+	*
+	* @return
+	*   bool
+	*/
+	bool Stale(const EntryT& entry, uint64_t generation, uint64_t now) const;
+
+};
+} // namespace search
+} // namespace zpds
+#endif // _ZPDS_SEARCH_RESULT_CACHE_HPP_
@@ -0,0 +1,178 @@
+/**
+ * @project zapdos
+ * @file include/search/RuleTagger.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  RuleTagger.hpp : Tags matches of a fused query to the profile rules they satisfy
+ *
+ */
+#ifndef _ZPDS_SEARCH_RULE_TAGGER_HPP_
+#define _ZPDS_SEARCH_RULE_TAGGER_HPP_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <xapian.h>
+
+namespace zpds {
+namespace search {
+
+/**
+* Collects matches of one query built for several rules as a match decider that rejects
+* everything. Terms not common to all rules are checked on posting cursors that only move
+* forward , so each posting list is read once. Each rule keeps its top items by value
+* descending with ties in docid order , same as sorting on that value in reverse.
+*
+*/
+class RuleTagger : public Xapian::MatchDecider {
+
+public:
+
+	using TermVecT = std::vector<std::string>;
+
+	struct ScoreT {
+		std::string key;
+		Xapian::docid did;
+	};
+	using ScoreVecT = std::vector<ScoreT>;
+
+	/**
+	* Constructor: default
+	*
+	*  @param db_
+	*     const Xapian::Database& db
+	*
+	*  @param slot_
+	*     Xapian::valueno value to sort on
+	*
+	*/
+	RuleTagger(const Xapian::Database& db_, Xapian::valueno slot_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	RuleTagger() = delete;
+	RuleTagger(const RuleTagger&) = delete;
+	RuleTagger& operator=(const RuleTagger&) = delete;
+
+	/**
+	* Destructor: default
+	*
+	*/
+	~RuleTagger();
+
+	/**
+	* AddRule: add a rule by terms it needs beyond the query
+	*
+	*  @param terms
+	*     const TermVecT& terms all needed
+	*
+	*  @param items
+	*     size_t top items to keep
+	*
+	*  @return
+	*   size_t rule index
+	*/
+	size_t AddRule(const TermVecT& terms, size_t items);
+
+	/**
+	* operator(): tag , always rejects
+	*
+	*  @param doc
+	*   Xapian::Document&  doc
+	*
+	*  @return
+	*   bool false
+	*/
+	bool operator()(const Xapian::Document& doc) const override;
+
+	/**
+	* Finish: get top items of a rule by key descending then docid
+	*
+	*  @param rule
+	*   size_t rule index
+	*
+	*  @return
+	*   ScoreVecT
+	*/
+	ScoreVecT Finish(size_t rule) const;
+
+protected:
+
+	struct CursorT {
+		std::string term;
+		Xapian::PostingIterator it;
+		Xapian::docid last;
+	};
+
+	struct RuleT {
+		std::vector<size_t> cursors;
+		size_t items;
+		ScoreVecT heap;
+	};
+
+	const Xapian::Database db;
+	const Xapian::valueno slot;
+	std::unordered_map<std::string, size_t> cursormap;
+	mutable std::vector<CursorT> cursors;
+	mutable std::vector<RuleT> rules;
+
+	/**
+	* Has: check if the term of a cursor is in document
+	*
+	*  @param cursor
+	*   size_t cursor index
+	*
+	*  @param did
+	*   Xapian::docid did
+	*
+	*  @return
+	*   bool
+	*/
+	bool Has(size_t cursor, Xapian::docid did) const;
+
+	/**
+	* Push: keep if in top items
+	*
+	*  @param rule
+	*   RuleT& rule
+	*
+	*  @param key
+	*   const std::string& key
+	*
+	*  @param did
+	*   Xapian::docid did
+	*
+	*  @return
+	*   none
+	*/
+	void Push(RuleT& rule, const std::string& key, Xapian::docid did) const;
+
+};
+} // namespace search
+} // namespace zpds
+#endif // _ZPDS_SEARCH_RULE_TAGGER_HPP_
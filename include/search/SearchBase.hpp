@@ -35,6 +35,7 @@
 
 #include "search/BaseUtils.hpp"
 #include "search/ReadIndex.hpp"
+#include "search/SearchContext.hpp"
 #include "../proto/Search.pb.h"
 #include "../proto/Query.pb.h"
 #include "store/HandleSession.hpp"
@@ -130,6 +131,20 @@ protected:
 	*/
 	bool GetExterProfile(::zpds::utils::SharedTable::pointer stptr, const std::string& exter, ::zpds::search::QueryProfT* profile);
 
+	/**
+	* GetResultKey : key of inputs that decide the ids of a profile search
+	*
+	* @param qprof
+	*   const QueryProfT* profile
+	*
+	* @param qr
+	*   const UsedParamsT* query params after normalizing
+	*
+	* @return
+	*   std::string
+	*/
+	std::string GetResultKey(const QueryProfT* qprof, const UsedParamsT* qr);
+
 	/**
 	* RuleSearch : do the search from rule, populate ids into cresp
 	*
@@ -144,6 +159,76 @@ protected:
 	*/
 	bool RuleSearch( UsedParamsT* params, const QueryRuleT* rule);
 
+	/**
+	* PrepareRule : set params from rule , check if rule applies
+	*
+	* @param params
+	*   UsedParamsT* query params
+	*
+	* @param rule
+	*   const QueryRuleT* query rules
+	*
+	* @return
+	*   bool if rule can run
+	*/
+	bool PrepareRule( UsedParamsT* params, const QueryRuleT* rule);
+
+	/**
+	* ScoreRule : scores from sortkeys as per rule order
+	*
+	* @param params
+	*   UsedParamsT* query params with ids and sortkeys
+	*
+	* @param rule
+	*   const QueryRuleT* query rules
+	*
+	* @return
+	*   none
+	*/
+	void ScoreRule( UsedParamsT* params, const QueryRuleT* rule);
+
+	/**
+	* FuseRules : run rules ordered by importance in one pass over a query built for all
+	*
+	* @param qr
+	*   const UsedParamsT* query params
+	*
+	* @param qprof
+	*   const QueryProfT* profile
+	*
+	* @param nqrs
+	*   std::vector<UsedParamsT>& params by rule , filled for rules done
+	*
+	* @param done
+	*   std::vector<bool>& set for rules done
+	*
+	* @return
+	*   size_t rules done
+	*/
+	size_t FuseRules(const UsedParamsT* qr, const QueryProfT* qprof,
+	                 std::vector<UsedParamsT>& nqrs, std::vector<bool>& done);
+
+
+	struct GeoRingT {
+		Xapian::Query filter;
+		double radius;
+	};
+	using GeoRingVecT = std::vector<GeoRingT>;
+
+	/**
+	* GetGeoRings: geohash filters widening around a point, each with the min distance
+	*   of any document outside it
+	*
+	* @param lat
+	*   double latitude
+	*
+	* @param lon
+	*   double longitude
+	*
+	* @return
+	*   GeoRingVecT rings nearest first, empty if none can be used
+	*/
+	GeoRingVecT GetGeoRings(double lat, double lon) const;
 
 	/**
 	* FindNear: check if exists nearby
@@ -173,6 +258,17 @@ protected:
 	*/
 	bool FindFull(::zpds::search::UsedParamsT* qr, bool reset);
 
+	/**
+	* FindPrefix: answer a one word partial query from prefix top documents
+	*
+	* @param qr
+	*   ::zpds::search::UsedParamsT* query
+	*
+	* @return
+	*   bool if answered , false if the index has to be searched
+	*/
+	bool FindPrefix(::zpds::search::UsedParamsT* qr);
+
 	WordVecT wordstr;
 
 	/**
@@ -195,13 +291,21 @@ protected:
 	size_t GetQuerySize();
 
 	/**
-	* GetQueryString: set query
+	* GetQuery: query from wordstr , rule terms and filters , all terms needed
+	*
+	* @param qr
+	*   const UsedParamsT* query params
 	*
-	* @param qtype
-	*   QueryWordsE enum type
+	* @return
+	*   Xapian::Query
+	*/
+	Xapian::Query GetQuery(const UsedParamsT* qr);
+
+	/**
+	* PartQuery: query for a partial word , expanded over full words if beyond the indexed length
 	*
-	* @param extra
-	*   const std::string& extra input
+	* @param word
+	*   const std::string& word
 	*
 	* @param full_prefix
 	*   const std::string& full prefix
@@ -210,12 +314,31 @@ protected:
 	*   const std::string& part prefix
 	*
 	* @return
-	*   std::string
+	*   Xapian::Query
+	*/
+	Xapian::Query PartQuery(const std::string& word, const std::string& full_prefix, const std::string& part_prefix);
+
+	/**
+	* GetQueryTerms: terms all needed for the query , sorted
+	*
+	* @param qr
+	*   const UsedParamsT* query params
+	*
+	* @return
+	*   WordVecT
+	*/
+	WordVecT GetQueryTerms(const UsedParamsT* qr);
+
+	/**
+	* PartsOverLimit: check if any partial word is beyond the indexed part length
+	*
+	* @param qr
+	*   const UsedParamsT* query params
+	*
+	* @return
+	*   bool true if the query needs wildcards
 	*/
-	std::string GetQueryString(
-	    QueryWordsE qtype, const std::string& extra,
-	    const std::string& full_prefix, const std::string& part_prefix
-	);
+	bool PartsOverLimit(const UsedParamsT* qr);
 
 
 	/**
@@ -61,6 +61,15 @@ public:
 	*/
 	SearchCache(const std::string& dbpath);
 
+	/**
+	* Constructor : with shared reader pool
+	*
+	* @param pool
+	*   ReaderPool::pointer pool
+	*
+	*/
+	SearchCache(ReaderPool::pointer pool);
+
 	/**
 	* make noncopyable and remove default
 	*/
@@ -112,8 +121,8 @@ protected:
 	/**
 	* DoWarmCache: cache warm by query
 	*
-	* @param db
-	*   DatabaseT& db
+	* @param tools
+	*   ReaderPool::ToolsT& enquire of the db
 	*
 	* @param wvec
 	*   WordVecT wvec
@@ -121,7 +130,7 @@ protected:
 	* @return
 	*   none
 	*/
-	void DoWarmCache(DatabaseT& db, WordVecT wvec);
+	void DoWarmCache(ReaderPool::ToolsT& tools, WordVecT wvec);
 
 };
 
@@ -0,0 +1,134 @@
+/**
+ * @project zapdos
+ * @file include/search/SearchContext.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  SearchContext.hpp : Per thread reusable search scratch Headers
+ *
+ */
+#ifndef _ZPDS_SEARCH_SEARCH_CONTEXT_HPP_
+#define _ZPDS_SEARCH_SEARCH_CONTEXT_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/BaseUtils.hpp"
+#include "../proto/Search.pb.h"
+
+// contexts kept idle per thread , more are only made when searches nest on a thread
+#define XAP_SEARCH_CONTEXT_KEEP 4
+
+namespace zpds {
+namespace search {
+
+/**
+* Scratch space of a search kept by the thread running it , buffers and params only
+* grow so a steady query load does not allocate for them. The enquire is kept on
+* the reader handle it is bound to.
+*
+*/
+class SearchContext {
+
+public:
+	using pointer = std::unique_ptr<SearchContext>;
+	using ParamsVecT = std::vector<UsedParamsT>;
+	using FlagVecT = std::vector<bool>;
+	using IndexVecT = std::vector<int>;
+
+	/**
+	* Acquire : an idle context of this thread , new if none
+	*
+	* @return
+	*   pointer
+	*/
+	static pointer Acquire();
+
+	/**
+	* Release : return a context to this thread for reuse
+	*
+	* @param ctx
+	*   pointer&& context moved
+	*
+	* @return
+	*   none
+	*/
+	static void Release(pointer&& ctx);
+
+	/**
+	* Constructor : default
+	*
+	*/
+	SearchContext();
+
+	/**
+	* make noncopyable
+	*/
+	SearchContext(const SearchContext&) = delete;
+	SearchContext& operator=(const SearchContext&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~SearchContext ();
+
+	// params of rules done in a fused pass
+	ParamsVecT fused;
+	FlagVecT done;
+
+	// params of rules of one weight
+	ParamsVecT group;
+	IndexVecT todo;
+
+	/**
+	* Scope : context held till end of scope
+	*
+	*/
+	class Scope {
+	public:
+		Scope() : ctx(Acquire()) {}
+		~Scope()
+		{
+			Release(std::move(ctx));
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		SearchContext* operator->() const
+		{
+			return ctx.get();
+		}
+	private:
+		pointer ctx;
+	};
+
+};
+
+} // namespace search
+} // namespace zpds
+#endif  // _ZPDS_SEARCH_SEARCH_CONTEXT_HPP_
+
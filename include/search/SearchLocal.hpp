@@ -55,6 +55,15 @@ public:
 	*/
 	SearchLocal(const std::string& dbpath);
 
+	/**
+	* Constructor : with shared reader pool
+	*
+	* @param pool
+	*   ReaderPool::pointer pool
+	*
+	*/
+	SearchLocal(ReaderPool::pointer pool);
+
 	/**
 	* make noncopyable and remove default
 	*/
@@ -55,6 +55,15 @@ public:
 	*/
 	SearchWiki(const std::string& dbpath);
 
+	/**
+	* Constructor : with shared reader pool
+	*
+	* @param pool
+	*   ReaderPool::pointer pool
+	*
+	*/
+	SearchWiki(ReaderPool::pointer pool);
+
 	/**
 	* make noncopyable and remove default
 	*/
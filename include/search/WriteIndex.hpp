@@ -34,7 +34,10 @@
 #define _ZPDS_SEARCH_WRITE_INDEX_HPP_
 
 #include <mutex>
+#include <deque>
+#include <atomic>
 #include <memory>
+#include <vector>
 #include <functional>
 #include <unordered_map>
 #include <xapian.h>
@@ -42,6 +45,12 @@
 #include "utils/BaseUtils.hpp"
 #include "../proto/Search.pb.h"
 
+#define XAP_PENDING_TERM_OVERHEAD 8
+#define XAP_MAX_SHARDS 64
+#define XAP_SHARDS_FILE "zpds_shards"
+#define XAP_CHANGE_MAX_TERMS 50000
+#define XAP_CHANGE_KEEP 16
+
 namespace zpds {
 namespace search {
 class WriteIndex {
@@ -49,23 +58,58 @@ class WriteIndex {
 public:
 
 	using DatabaseT = Xapian::WritableDatabase;
-	using TrieMapT = std::unordered_map< int, DatabaseT >;
+	using IdTermsT = std::vector<std::string>;
+
+	// one writable shard with its own lock , with idterms changed since its last commit
+	struct ShardT {
+		std::mutex lock;
+		DatabaseT db;
+		IdTermsT changed;
+		bool overflow = false;
+	};
+	using ShardPtrT = std::unique_ptr<ShardT>;
+	using ShardVecT = std::vector<ShardPtrT>;
+	using TrieMapT = std::unordered_map< int, ShardVecT >;
 
 	using pointer = std::shared_ptr<WriteIndex>;
 
+	// immutable view of last commit , published after every commit
+	struct SnapshotT {
+		uint64_t generation;
+		uint64_t committed_at;
+		uint64_t doccount;
+	};
+	using SnapshotPtrT = std::shared_ptr<const SnapshotT>;
+
+	// idterms changed by one commit per index , overflow if too many to keep
+	struct ChangesT {
+		IdTermsT idterms;
+		bool overflow = false;
+	};
+	using ChangeMapT = std::unordered_map< int, ChangesT >;
+	struct ChangeLogT {
+		uint64_t generation;
+		ChangeMapT changes;
+	};
+	using ChangeLogPtrT = std::shared_ptr<const ChangeLogT>;
+	using ChangeLogListT = std::deque<ChangeLogPtrT>;
+
 	/**
 	* Create : create WriteIndex
 	*
 	* @param dbpath_
 	*   std::string dbpath
 	*
+	* @param shards_
+	*   size_t number of shards per index
+	*
 	* @return
 	*   std::shared_ptr<WriteIndex>
 	*
 	*/
-	static pointer Create(std::string dbpath_)
+	static pointer Create(std::string dbpath_, size_t shards_=1)
 	{
-		return std::make_shared<WriteIndex>(std::move(dbpath_));
+		return std::make_shared<WriteIndex>(std::move(dbpath_), shards_);
 	}
 
 	/**
@@ -74,8 +118,14 @@ public:
 	* @param dbpath_
 	*   std::string dbpath
 	*
+	* @param shards_
+	*   size_t number of shards per index
+	*
+	* @param flags_
+	*   int xapian open flags
+	*
 	*/
-	WriteIndex(std::string dbpath_);
+	WriteIndex(std::string dbpath_, size_t shards_=1, int flags_=Xapian::DB_CREATE_OR_OPEN);
 
 	/**
 	* make noncopyable and remove default
@@ -97,6 +147,106 @@ public:
 	*/
 	void CommitData();
 
+	/**
+	* GetGeneration : commit generation , incremented after every commit
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetGeneration() const;
+
+	/**
+	* GetSnapshot : last published commit snapshot , lock free
+	*
+	* @return
+	*   SnapshotPtrT
+	*/
+	SnapshotPtrT GetSnapshot() const;
+
+	/**
+	* GetChanges : idterms changed in an index by commits after one generation upto another
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param after
+	*   uint64_t generation already seen
+	*
+	* @param upto
+	*   uint64_t generation to reach
+	*
+	* @param idterms
+	*   IdTermsT& idterms appended
+	*
+	* @return
+	*   bool false if the log does not cover all these commits
+	*/
+	bool GetChanges(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
+	                uint64_t after, uint64_t upto, IdTermsT& idterms);
+
+	/**
+	* GetPendingDocs , GetPendingBytes : uncommitted changes since last commit
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetPendingDocs() const;
+	uint64_t GetPendingBytes() const;
+
+	/**
+	* GetPendingSince : time in ms of first uncommitted change , 0 if none
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetPendingSince() const;
+
+	/**
+	* GetShardCount : number of shards per index
+	*
+	* @return
+	*   size_t
+	*/
+	size_t GetShardCount() const;
+
+	/**
+	* ShardPath : path of one shard , shard 0 is the unsharded path
+	*
+	* @param dbpath
+	*   const std::string& base path
+	*
+	* @param ltyp
+	*   ::zpds::search::LangTypeE ltyp
+	*
+	* @param dtyp
+	*   ::zpds::search::IndexTypeE dtyp
+	*
+	* @param shard
+	*   size_t shard no
+	*
+	* @return
+	*   std::string
+	*/
+	static std::string ShardPath(const std::string& dbpath,
+	                             ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, size_t shard);
+
+	/**
+	* ShardNo : shard for an idterm , stable across builds
+	*
+	* @param idterm
+	*   const std::string& idterm
+	*
+	* @param shards
+	*   size_t number of shards
+	*
+	* @return
+	*   size_t
+	*/
+	static size_t ShardNo(const std::string& idterm, size_t shards);
+
 	/**
 	* Update: update a document
 	*
@@ -136,12 +286,45 @@ public:
 	void Delete(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const std::string& idterm);
 
 protected:
-	std::mutex update_lock;
+	std::mutex commit_lock;
 	const std::string dbpath;
+	const size_t shards;
+	const int flags;
 	TrieMapT triemap;
+	SnapshotPtrT snapshot;
+	std::atomic<uint64_t> pending_docs;
+	std::atomic<uint64_t> pending_bytes;
+	std::atomic<uint64_t> pending_since;
+	std::mutex change_lock;
+	ChangeLogListT changelog;
 
 	/**
-	* Get: get the storage instance
+	* AddChanged: record a changed idterm , call under shard lock
+	*
+	* @param shard
+	*   ShardT& shard
+	*
+	* @param idterm
+	*   const std::string& idterm
+	*
+	* @return
+	*   none
+	*/
+	void AddChanged(ShardT& shard, const std::string& idterm);
+
+	/**
+	* AddPending: account one uncommitted change
+	*
+	* @param bytes
+	*   uint64_t approx bytes of postings
+	*
+	* @return
+	*   none
+	*/
+	void AddPending(uint64_t bytes);
+
+	/**
+	* Get: get the shard for an idterm
 	*
 	* @param ltyp
 	*   ::zpds::search::LangTypeE ltyp
@@ -149,10 +332,21 @@ protected:
 	* @param dtyp
 	*   ::zpds::search::IndexTypeE dtyp
 	*
+	* @param idterm
+	*   const std::string& idterm
+	*
+	* @return
+	*   ShardT&
+	*/
+	virtual ShardT& Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const std::string& idterm);
+
+	/**
+	* CheckShards: check shard count against the one stored with the index
+	*
 	* @return
-	*   DatabaseT&
+	*   none , throws if mismatch
 	*/
-	virtual DatabaseT& Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp);
+	void CheckShards();
 
 };
 
@@ -36,8 +36,12 @@
 #include <memory>
 #include <utility>
 #include <functional>
-#include <boost/thread/locks.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include <mutex>
+#include <atomic>
+#include <list>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include <boost/functional/hash.hpp>
 
 #ifdef ZPDS_USE_SPARSE_HASH_CACHE
 #include "sparsepp/spp.h"
@@ -47,31 +51,57 @@
 
 #include "store/StoreBase.hpp"
 
+#define ZPDS_CACHE_DEFAULT_SHARDS 16
+#define ZPDS_CACHE_DEFAULT_MB 128
+// approx bytes taken by an entry besides its key and value
+#define ZPDS_CACHE_ENTRY_OVERHEAD 128
+
 namespace zpds {
 namespace store {
 class CacheContainer : virtual public StoreBase {
 public:
 	using pointer=std::shared_ptr<CacheContainer>;
-	using LockT = boost::shared_mutex;
-	using WriteLockT = boost::unique_lock< LockT >;
-	using ReadLockT = boost::shared_lock< LockT >;
+	using LockT = std::mutex;
+	using WriteLockT = std::lock_guard< LockT >;
 
 	using AssocT = std::string;
+	using KeyT = boost::string_view;
+
+	struct KeyHashT {
+		size_t operator()(const KeyT& key) const
+		{
+			return boost::hash_range(key.begin(), key.end());
+		}
+	};
+
+	struct EntryT {
+		std::string hash;
+		AssocT assoc;
+	};
+	using LruListT = std::list<EntryT>;
+
+	// keys are views of the hash in the list entry
 #ifdef ZPDS_USE_SPARSE_HASH_CACHE
-	using AssocMapT = spp::sparse_hash_map<std::string,AssocT>;
+	using AssocMapT = spp::sparse_hash_map<KeyT,LruListT::iterator,KeyHashT>;
 #else
-	using AssocMapT = std::unordered_map<std::string,AssocT>;
+	using AssocMapT = std::unordered_map<KeyT,LruListT::iterator,KeyHashT>;
 #endif // ZPDS_USE_SPARSE_HASH_CACHE
 
 	/**
 	* create : static construction creates new first time
 	*
+	* @param max_bytes
+	*   size_t approx memory limit , least recently used entries go beyond it , 0 is no limit
+	*
+	* @param shards
+	*   size_t no of separately locked parts
+	*
 	* @return
 	*   pointer
 	*/
-	static pointer create()
+	static pointer create(size_t max_bytes=0, size_t shards=ZPDS_CACHE_DEFAULT_SHARDS)
 	{
-		pointer p(new CacheContainer());
+		pointer p(new CacheContainer(max_bytes, shards));
 		return p;
 	}
 
@@ -88,7 +118,7 @@ public:
 	* SetAssoc : add an assoc entry
 	*
 	* @param hash
-	*   std::string hash to update
+	*   KeyT hash to update
 	*
 	* @param assoc
 	*   AssocT assoc
@@ -99,13 +129,13 @@ public:
 	* @return
 	*   none
 	*/
-	void SetAssoc(std::string hash, AssocT assoc, bool only_if_exists=false);
+	void SetAssoc(KeyT hash, AssocT assoc, bool only_if_exists=false);
 
 	/**
 	* GetAssoc : get assoc
 	*
 	* @param hash
-	*   std::string hash to get
+	*   KeyT hash to get
 	*
 	* @param assoc
 	*   AssocT& assoc to get
@@ -113,29 +143,29 @@ public:
 	* @return
 	*   bool if ok
 	*/
-	bool GetAssoc(std::string hash, AssocT& assoc);
+	bool GetAssoc(KeyT hash, AssocT& assoc);
 
 	/**
 	* DelAssoc : del assoc entry
 	*
 	* @param hash
-	*   std::string&& hash to update
+	*   KeyT hash to update
 	*
 	* @return
 	*   none
 	*/
-	void DelAssoc(std::string hash);
+	void DelAssoc(KeyT hash);
 
 	/**
 	* CheckAssoc : get assoc
 	*
 	* @param hash
-	*   std::string hash to get
+	*   KeyT hash to get
 	*
 	* @return
 	*   bool if ok
 	*/
-	bool CheckAssoc(std::string hash);
+	bool CheckAssoc(KeyT hash);
 
 	/**
 	* AssocSize : get assoc size
@@ -145,15 +175,102 @@ public:
 	*/
 	size_t AssocSize();
 
+	/**
+	* GetShards : no of shards
+	*
+	* @return
+	*   size_t
+	*/
+	size_t GetShards() const;
+
+	/**
+	* GetHits , GetMisses , GetEvictions , GetBytes , GetEntries : counters of a shard
+	*
+	* @param shard
+	*   size_t shard less than GetShards
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetHits(size_t shard) const;
+	uint64_t GetMisses(size_t shard) const;
+	uint64_t GetEvictions(size_t shard) const;
+	uint64_t GetBytes(size_t shard) const;
+	uint64_t GetEntries(size_t shard) const;
+
 private:
-	LockT mutex_;
-	AssocMapT assoc_map;
+	struct ShardT {
+		LockT mutex_;
+		LruListT lru; // most recent first
+		AssocMapT assoc_map;
+		std::atomic<uint64_t> bytes{0};
+		std::atomic<uint64_t> entries{0};
+		std::atomic<uint64_t> hits{0};
+		std::atomic<uint64_t> misses{0};
+		std::atomic<uint64_t> evictions{0};
+	};
+
+	const size_t shard_bytes;
+	std::vector<std::unique_ptr<ShardT>> shards_;
+
+	/**
+	* Constructor : private
+	*
+	* @param max_bytes
+	*   size_t approx memory limit , 0 is no limit
+	*
+	* @param shards
+	*   size_t no of separately locked parts
+	*
+	*/
+	CacheContainer(size_t max_bytes, size_t shards);
 
 	/**
-	* Constructor : default private
+	* GetShard : shard of a hash
 	*
+	* @param hash
+	*   KeyT hash
+	*
+	* @return
+	*   ShardT&
+	*/
+	ShardT& GetShard(KeyT hash);
+
+	/**
+	* GetShard : shard by no
+	*
+	* @param shard
+	*   size_t shard less than GetShards
+	*
+	* @return
+	*   const ShardT&
+	*/
+	const ShardT& GetShard(size_t shard) const;
+
+	/**
+	* Erase : remove an entry , lock held
+	*
+	* @param sh
+	*   ShardT& shard
+	*
+	* @param it
+	*   LruListT::iterator entry
+	*
+	* @return
+	*   none
+	*/
+	void Erase(ShardT& sh, LruListT::iterator it);
+
+	/**
+	* EntryBytes : approx memory of an entry
+	*
+	* @param entry
+	*   const EntryT& entry
+	*
+	* @return
+	*   size_t
 	*/
-	CacheContainer();
+	static size_t EntryBytes(const EntryT& entry);
 
 };
 } // namespace store
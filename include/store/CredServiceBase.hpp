@@ -69,6 +69,17 @@ public:
 	*/
 	virtual std::string Pack(::zpds::store::UserDataT* data) const =0;
 
+	/**
+	* GetCacheKey : key of the user in dbcache and sesscache
+	*
+	* @param name
+	*   const std::string& user name
+	*
+	* @return
+	*   std::string
+	*/
+	virtual std::string GetCacheKey(const std::string& name) const =0;
+
 	/**
 	* GetSession: get session key
 	*
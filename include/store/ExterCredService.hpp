@@ -70,6 +70,17 @@ public:
 	*/
 	std::string Pack(::zpds::store::ExterDataT* data) const override;
 
+	/**
+	* GetCacheKey : key of the user in dbcache and sesscache
+	*
+	* @param name
+	*   const std::string& user name
+	*
+	* @return
+	*   std::string
+	*/
+	std::string GetCacheKey(const std::string& name) const override;
+
 protected:
 };
 } // namespace store
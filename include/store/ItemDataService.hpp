@@ -328,12 +328,16 @@ protected:
 	* @param fields
 	*   int32_t fields fields use ZPDS_VDFLD_* with logical
 	*
+	* @param fetched
+	*   ::zpds::store::ItemDataT* record already read , consumed , nullptr to read
+	*
 	* @return
 	*   none
 	*/
 	void ReadData(::zpds::utils::SharedTable::pointer stptr,
 	              ::zpds::store::UserDataT* reader,
-	              ::zpds::store::ItemDataT* data, int32_t fields);
+	              ::zpds::store::ItemDataT* data, int32_t fields,
+	              ::zpds::store::ItemDataT* fetched=nullptr);
 
 };
 
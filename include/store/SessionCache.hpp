@@ -0,0 +1,227 @@
+/**
+ * @project zapdos
+ * @file include/store/SessionCache.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  SessionCache.hpp : Verified session keys with their user record Headers
+ *
+ */
+#ifndef _ZPDS_STORE_SESSION_CACHE_HPP_
+#define _ZPDS_STORE_SESSION_CACHE_HPP_
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <list>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "utils/BaseUtils.hpp"
+#include "../proto/Store.pb.h"
+
+#define ZPDS_SESSION_CACHE_USERS 10000
+#define ZPDS_SESSION_CACHE_SHARDS 16
+#define ZPDS_SESSION_CACHE_PER_USER 5
+
+namespace zpds {
+namespace store {
+
+/**
+* Session keys already decoded and checked , by user cache key , with the user record they
+* were checked against. A user record change drops the user so the next check decodes again.
+*
+*/
+class SessionCache {
+public:
+	using pointer = std::shared_ptr<SessionCache>;
+	using RecordT = std::shared_ptr<const ::zpds::store::UserDataT>;
+
+	/**
+	* Create : create SessionCache
+	*
+	* @param max_users_
+	*   size_t users kept , least recently checked go beyond it
+	*
+	* @param per_user_
+	*   size_t session keys kept per user
+	*
+	* @return
+	*   std::shared_ptr<SessionCache>
+	*
+	*/
+	static pointer Create(size_t max_users_, size_t per_user_=ZPDS_SESSION_CACHE_PER_USER)
+	{
+		return std::make_shared<SessionCache>(max_users_, per_user_);
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param max_users_
+	*   size_t users kept
+	*
+	* @param per_user_
+	*   size_t session keys kept per user
+	*
+	*/
+	SessionCache(size_t max_users_, size_t per_user_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	SessionCache() = delete;
+	SessionCache(const SessionCache&) = delete;
+	SessionCache& operator=(const SessionCache&) = delete;
+
+	/**
+	* destructor
+	*/
+	virtual ~SessionCache ();
+
+	/**
+	* Get : record of a checked session key not yet expired
+	*
+	* @param key
+	*   const std::string& user cache key
+	*
+	* @param sessionkey
+	*   const std::string& session key
+	*
+	* @param currtime
+	*   uint64_t current time ms
+	*
+	* @param data
+	*   ::zpds::store::UserDataT* data to fill
+	*
+	* @return
+	*   bool if found
+	*/
+	bool Get(const std::string& key, const std::string& sessionkey, uint64_t currtime, ::zpds::store::UserDataT* data);
+
+	/**
+	* GetGeneration : take before reading the record that a session key is checked against
+	*
+	* @param key
+	*   const std::string& user cache key
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetGeneration(const std::string& key);
+
+	/**
+	* Set : keep a checked session key , not kept if the user changed since generation
+	*
+	* @param key
+	*   const std::string& user cache key
+	*
+	* @param sessionkey
+	*   const std::string& session key
+	*
+	* @param expires_at
+	*   uint64_t expiry time ms
+	*
+	* @param generation
+	*   uint64_t from GetGeneration
+	*
+	* @param data
+	*   const ::zpds::store::UserDataT* record checked against
+	*
+	* @return
+	*   none
+	*/
+	void Set(const std::string& key, const std::string& sessionkey, uint64_t expires_at,
+	         uint64_t generation, const ::zpds::store::UserDataT* data);
+
+	/**
+	* Del : drop a user with all session keys
+	*
+	* @param key
+	*   const std::string& user cache key
+	*
+	* @return
+	*   none
+	*/
+	void Del(const std::string& key);
+
+	/**
+	* GetHits , GetMisses , GetEntries : counters
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetHits() const;
+	uint64_t GetMisses() const;
+	uint64_t GetEntries() const;
+
+protected:
+	struct SessionT {
+		std::string sessionkey;
+		uint64_t expires_at;
+	};
+
+	struct EntryT {
+		std::string key;
+		RecordT record;
+		std::vector<SessionT> sessions; // most recent last
+	};
+	using LruListT = std::list<EntryT>;
+	using EntryMapT = std::unordered_map<std::string, LruListT::iterator>;
+
+	struct ShardT {
+		std::mutex lock;
+		LruListT lru; // most recent first
+		EntryMapT entries;
+		uint64_t generation=0;
+	};
+
+	const size_t shard_users;
+	const size_t per_user;
+	ShardT shards[ZPDS_SESSION_CACHE_SHARDS];
+
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> count;
+
+	/**
+	* GetShard : shard of a key
+	*
+	* @param key
+	*   const std::string& user cache key
+	*
+	* @return
+	*   ShardT&
+	*/
+	ShardT& GetShard(const std::string& key);
+
+};
+
+} // namespace store
+} // namespace zpds
+
+#endif  // _ZPDS_STORE_SESSION_CACHE_HPP_
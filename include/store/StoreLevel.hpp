@@ -33,6 +33,7 @@
 #ifndef _ZPDS_STORE_STORELEVEL_HPP_
 #define _ZPDS_STORE_STORELEVEL_HPP_
 
+#include <vector>
 #include "store/StoreBase.hpp"
 
 #ifdef ZPDS_BUILD_WITH_LEVELDB
@@ -98,6 +99,20 @@ public:
 	*/
 	dbpointer getDB();
 
+	/**
+	* MultiRead: read many keys in one call , in key order for locality
+	*
+	* @param keys
+	*   const std::vector<std::string>& keys to read
+	*
+	* @param values
+	*   std::vector<std::string>& values in order of keys
+	*
+	* @return
+	*   std::vector<bool> if found in order of keys
+	*/
+	std::vector<bool> MultiRead(const std::vector<std::string>& keys, std::vector<std::string>& values);
+
 protected:
 	dbpointer db;
 
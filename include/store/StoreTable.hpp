@@ -34,10 +34,16 @@
 #define _ZPDS_STORE_STORE_TABLE_HPP_
 
 #include <set>
+#include <vector>
+#include <atomic>
 #include <google/protobuf/reflection.h>
 #include <google/protobuf/repeated_field.h>
 
 #include "store/StoreLevel.hpp"
+#include "async++.h"
+
+// batches at least this big are parsed in parallel
+#define ZPDS_BATCH_PARSE_MIN 64
 
 namespace zpds {
 namespace store {
@@ -140,6 +146,85 @@ public:
 	}
 
 
+	/**
+	* GetBatch: get records in one read , unique keys are resolved to ids in one read before
+	*
+	* @param records
+	*   VecT* records with id or unique key set , notfound set if missing
+	*
+	* @param keytypes
+	*   const std::vector<KeyTypeE>& key to use for each record , NOKEY to skip
+	*
+	* @return
+	*   size_t records found
+	*/
+	size_t GetBatch(VecT* records, const std::vector<KeyTypeE>& keytypes)
+	{
+		if ( keytypes.size() != (size_t)records->size() )
+			throw zpds::BadCodeException("Keytypes do not match records");
+
+		std::vector<std::string> keys;
+		std::vector<std::string> values;
+		std::vector<int> which;
+
+		// unique keys to ids
+		for (auto i=0 ; i < records->size() ; ++i) {
+			auto keytype = keytypes[i];
+			if ( keytype==NOKEY || keytype==PrimaryKey ) continue;
+			if ( unique_keys.find(keytype)==unique_keys.end() && index_keys.find(keytype)==index_keys.end() )
+				throw zpds::BadDataException("Keytype invalid");
+			keys.emplace_back( GetKey(records->Mutable(i),keytype,false) );
+			which.push_back(i);
+		}
+		std::vector<bool> resolved( records->size(), false );
+		if (!keys.empty()) {
+			auto found = MultiRead(keys, values);
+			for (size_t j=0 ; j < which.size() ; ++j) {
+				NodeT node;
+				if ( !found[j] || !node.ParseFromString(values[j]) ) continue;
+				records->Mutable( which[j] )->set_id( node.id() );
+				resolved[ which[j] ] = true;
+			}
+		}
+
+		// primary keys
+		keys.clear();
+		which.clear();
+		for (auto i=0 ; i < records->size() ; ++i) {
+			if ( keytypes[i]==PrimaryKey || resolved[i] ) {
+				keys.emplace_back( GetKey(records->Mutable(i),PrimaryKey,false) );
+				which.push_back(i);
+			}
+			else {
+				records->Mutable(i)->set_notfound(true);
+			}
+		}
+		if (keys.empty()) return 0;
+		auto found = MultiRead(keys, values);
+
+		std::atomic<size_t> count{0};
+		std::atomic<bool> bad{false};
+		auto parse = [&](size_t j) {
+			auto record = records->Mutable( which[j] );
+			if (!found[j]) {
+				record->set_notfound(true);
+				return;
+			}
+			if (!record->ParseFromString(values[j])) {
+				bad = true;
+				return;
+			}
+			++count;
+		};
+		if ( which.size() >= ZPDS_BATCH_PARSE_MIN )
+			async::parallel_for( async::irange(size_t(0), which.size()), parse );
+		else
+			for (size_t j=0 ; j < which.size() ; ++j) parse(j);
+
+		if (bad) throw zpds::BadDataException("Record cannot be parsed");
+		return count;
+	}
+
 	/**
 	* GetMany: get all values by non unique key
 	*
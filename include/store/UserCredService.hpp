@@ -73,6 +73,17 @@ public:
 	*/
 	std::string Pack(::zpds::store::UserDataT* data) const override;
 
+	/**
+	* GetCacheKey : key of the user in dbcache and sesscache
+	*
+	* @param name
+	*   const std::string& user name
+	*
+	* @return
+	*   std::string
+	*/
+	std::string GetCacheKey(const std::string& name) const override;
+
 	/**
 	* ValidateUserCategories : gets the user and categories
 	*
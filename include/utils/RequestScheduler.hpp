@@ -0,0 +1,251 @@
+/**
+ * @project zapdos
+ * @file include/utils/RequestScheduler.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  RequestScheduler.hpp : Bounded request queues by traffic class Headers
+ *
+ */
+#ifndef _ZPDS_UTILS_REQUEST_SCHEDULER_HPP_
+#define _ZPDS_UTILS_REQUEST_SCHEDULER_HPP_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+#include "utils/BaseUtils.hpp"
+#include "utils/ThreadPin.hpp"
+
+#define ZPDS_SCHED_DEFAULT_THREADS 4
+#define ZPDS_SCHED_DEFAULT_QUEUE 1024
+
+namespace zpds {
+namespace utils {
+
+/**
+* Runs http handlers on a fixed set of threads per traffic class with a bounded queue each.
+* A request is refused at once if its queue is full or the oldest one waiting is already past
+* the deadline , and is dropped if it waited longer than the deadline before a thread got it.
+*
+*/
+class RequestScheduler {
+
+public:
+	using pointer = std::shared_ptr<RequestScheduler>;
+	using TaskT = std::function<void()>;
+	using ClockT = std::chrono::steady_clock;
+
+	enum ClassE {
+		REQ_QUERY   = 0,
+		REQ_ADMIN   = 1,
+		REQ_HRPC    = 2,
+		REQ_CLASSES = 3
+	};
+
+	struct ParamsT {
+		size_t threads=0;      // zero takes default
+		size_t queue=0;        // zero takes default
+		uint64_t deadline_ms=0; // zero is no deadline
+		ThreadPin::CpuListT cpus; // empty is not pinned
+	};
+	using ParamsListT = std::vector<ParamsT>;
+
+	/**
+	* Create : create RequestScheduler and start the threads
+	*
+	* @param params_
+	*   const ParamsListT& params by ClassE , missing take default
+	*
+	* @return
+	*   std::shared_ptr<RequestScheduler>
+	*
+	*/
+	static pointer Create(const ParamsListT& params_)
+	{
+		auto p = std::make_shared<RequestScheduler>(params_);
+		p->Start();
+		return p;
+	}
+
+	/**
+	* Constructor : default
+	*
+	* @param params_
+	*   const ParamsListT& params by ClassE , missing take default
+	*
+	*/
+	RequestScheduler(const ParamsListT& params_);
+
+	/**
+	* make noncopyable and remove default
+	*/
+	RequestScheduler() = delete;
+	RequestScheduler(const RequestScheduler&) = delete;
+	RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+	/**
+	* destructor : stops the threads
+	*/
+	virtual ~RequestScheduler ();
+
+	/**
+	* Start : start the threads of all classes
+	*
+	* @return
+	*   none
+	*/
+	void Start();
+
+	/**
+	* Stop : run what is queued and stop the threads
+	*
+	* @return
+	*   none
+	*/
+	void Stop();
+
+	/**
+	* Submit : queue a request , reject is run instead of task if refused or dropped
+	*
+	* @param cls
+	*   ClassE traffic class
+	*
+	* @param task
+	*   TaskT&& handler
+	*
+	* @param reject
+	*   TaskT&& on refusal , in the caller thread if refused at once
+	*
+	* @return
+	*   bool false if refused at once
+	*/
+	bool Submit(ClassE cls, TaskT&& task, TaskT&& reject);
+
+	/**
+	* GetName : class name for counters
+	*
+	* @param cls
+	*   ClassE traffic class
+	*
+	* @return
+	*   const char*
+	*/
+	static const char* GetName(ClassE cls);
+
+	/**
+	* GetThreads , GetDepth , GetAccepted , GetDone , GetShed , GetExpired : counters by class
+	*
+	* @param cls
+	*   ClassE traffic class
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetThreads(ClassE cls) const;
+	uint64_t GetDepth(ClassE cls) const;
+	uint64_t GetAccepted(ClassE cls) const;
+	uint64_t GetDone(ClassE cls) const;
+	uint64_t GetShed(ClassE cls) const;
+	uint64_t GetExpired(ClassE cls) const;
+
+	/**
+	* GetWaitAvg , GetWaitMax : queue wait in microseconds of requests run , by class
+	*
+	* @param cls
+	*   ClassE traffic class
+	*
+	* @return
+	*   uint64_t
+	*/
+	uint64_t GetWaitAvg(ClassE cls) const;
+	uint64_t GetWaitMax(ClassE cls) const;
+
+protected:
+	struct JobT {
+		TaskT task;
+		TaskT reject;
+		ClockT::time_point queued_at;
+	};
+
+	struct QueueT {
+		size_t threads;
+		size_t capacity;
+		uint64_t deadline_ms;
+		ThreadPin::CpuListT cpus;
+
+		std::mutex lock;
+		std::condition_variable cv;
+		std::deque<JobT> jobs;
+		std::vector<std::thread> workers;
+		bool stopping=false;
+
+		std::atomic<uint64_t> depth{0};
+		std::atomic<uint64_t> accepted{0};
+		std::atomic<uint64_t> done{0};
+		std::atomic<uint64_t> shed{0};
+		std::atomic<uint64_t> expired{0};
+		std::atomic<uint64_t> started{0};
+		std::atomic<uint64_t> wait_total{0};
+		std::atomic<uint64_t> wait_max{0};
+	};
+
+	QueueT queues[REQ_CLASSES];
+
+	/**
+	* Work : worker thread loop of a class
+	*
+	* @param q
+	*   QueueT* queue
+	*
+	* @return
+	*   none
+	*/
+	void Work(QueueT* q);
+
+	/**
+	* Get : queue of a class
+	*
+	* @param cls
+	*   ClassE traffic class
+	*
+	* @return
+	*   const QueueT&
+	*/
+	const QueueT& Get(ClassE cls) const;
+
+};
+
+} // namespace utils
+} // namespace zpds
+
+#endif  // _ZPDS_UTILS_REQUEST_SCHEDULER_HPP_
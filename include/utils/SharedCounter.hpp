@@ -39,9 +39,6 @@ namespace zpds {
 namespace utils {
 class SharedCounter : public SharedObject<uint64_t> {
 public:
-	using LockT = SharedObject<uint64_t>::LockT;
-	using WriteLockT = SharedObject<uint64_t>::WriteLockT;
-	using ReadLockT = SharedObject<uint64_t>::ReadLockT;
 
 	/**
 	* make noncopyable and remove default
@@ -69,9 +66,7 @@ public:
 	*/
 	uint64_t GetNext()
 	{
-		WriteLockT writelock(mutex_);
-		++t_;
-		return t_;
+		return t_.fetch_add(1, std::memory_order_acq_rel) + 1;
 	}
 
 };
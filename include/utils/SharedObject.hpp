@@ -34,17 +34,93 @@
 #define _ZPDS_UTILS_SHARED_OBJECT_HPP_
 
 #include <functional>
-#include <boost/thread/locks.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include <memory>
+#include <atomic>
+#include <type_traits>
 
 namespace zpds {
 namespace utils {
-template <class T>
+
+/**
+* Shared value read far more often than set. Readers take the current copy without a lock ,
+* a writer publishes a new copy and readers still holding the old one keep it till done.
+*
+*/
+template <class T, class Enable=void>
 class SharedObject {
 public:
-	using LockT = boost::shared_mutex;
-	using WriteLockT = boost::unique_lock< LockT >;
-	using ReadLockT = boost::shared_lock< LockT >;
+	using ValueT = std::shared_ptr<const T>;
+
+	/**
+	* make noncopyable and remove default
+	*/
+
+	SharedObject(const SharedObject&) = delete;
+	SharedObject& operator=(const SharedObject&) = delete;
+
+	/**
+	* Constructor : default
+	*
+	* @param t
+	*   T initial value
+	*
+	*/
+	SharedObject() : p_(std::make_shared<const T>()) {}
+	SharedObject(T t) : p_(std::make_shared<const T>(std::move(t))) {}
+
+	/**
+	* destructor
+	*/
+	virtual ~SharedObject () {}
+
+	/**
+	* Set : set
+	*
+	* @param t
+	*   T value to set
+	*
+	* @return
+	*   none
+	*/
+	void Set(T t)
+	{
+		std::atomic_store_explicit(&p_, ValueT(std::make_shared<const T>(std::move(t))), std::memory_order_release);
+	}
+
+	/**
+	* Get : get
+	*
+	* @return
+	*   T value copy
+	*/
+	T Get() const
+	{
+		return *GetPtr();
+	}
+
+	/**
+	* GetPtr : current value without copy , stays valid after a Set
+	*
+	* @return
+	*   ValueT
+	*/
+	ValueT GetPtr() const
+	{
+		return std::atomic_load_explicit(&p_, std::memory_order_acquire);
+	}
+
+protected:
+	ValueT p_;
+
+};
+
+/**
+* Integral values like flags and counters are a single atomic word.
+*
+*/
+template <class T>
+class SharedObject<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+public:
 
 	/**
 	* make noncopyable and remove default
@@ -60,7 +136,7 @@ public:
 	*   T initial value
 	*
 	*/
-	SharedObject() {}
+	SharedObject() : t_(T()) {}
 	SharedObject(T t) : t_(t) {}
 
 	/**
@@ -79,8 +155,7 @@ public:
 	*/
 	void Set(T t)
 	{
-		WriteLockT writelock(mutex_);
-		t_=t;
+		t_.store(t, std::memory_order_release);
 	}
 
 	/**
@@ -89,16 +164,16 @@ public:
 	* @return
 	*   T value copy
 	*/
-	T Get()
+	T Get() const
 	{
-		ReadLockT readlock(mutex_);
-		return t_;
+		return t_.load(std::memory_order_acquire);
 	}
 
-	T t_;
-	LockT mutex_;
+protected:
+	std::atomic<T> t_;
 
 };
+
 } // namespace utils
 } // namespace zpds
 #endif /* _ZPDS_UTILS_SHARED_OBJECT_HPP_ */
@@ -43,14 +43,22 @@
 #include "utils/SharedCounter.hpp"
 #include "utils/SharedPairMap.hpp"
 #include "utils/SharedMap.hpp"
+#include "utils/RequestScheduler.hpp"
 // #include "utils/SharedQueue.hpp"
 
 #include "store/StoreLevel.hpp"
 
 #include "store/CacheContainer.hpp"
+#include "store/SessionCache.hpp"
+
+#include "http/HttpCompress.hpp"
 
 #ifdef ZPDS_BUILD_WITH_XAPIAN
 #include "search/WriteIndex.hpp"
+#include "search/ReaderPool.hpp"
+#include "search/CommitScheduler.hpp"
+#include "search/IndexPipeline.hpp"
+#include "search/ResultCache.hpp"
 #include "jamspell/StoreJam.hpp"
 #endif
 
@@ -75,9 +83,18 @@ public:
 	using SharedTrans = SharedMap<uint64_t,std::string>;
 
 	using SharedCache = zpds::store::CacheContainer::pointer;
+	using SharedSessions = zpds::store::SessionCache::pointer;
+
+	using SharedHttpCompress = zpds::http::HttpCompress::pointer;
+
+	using SharedScheduler = zpds::utils::RequestScheduler::pointer;
 
 #ifdef ZPDS_BUILD_WITH_XAPIAN
 	using SharedXap = zpds::search::WriteIndex::pointer;
+	using SharedXapPool = zpds::search::ReaderPool::pointer;
+	using SharedXapCommit = zpds::search::CommitScheduler::pointer;
+	using SharedXapIndexer = zpds::search::IndexPipeline::pointer;
+	using SharedXapResults = zpds::search::ResultCache::pointer;
 	using SharedJam = zpds::jamspell::StoreJam::pointer;
 #endif
 
@@ -108,6 +125,10 @@ public:
 	// xapian
 	SharedString xapath;
 	SharedXap xapdb;
+	SharedXapPool xappool;
+	SharedXapCommit xapcommit;
+	SharedXapIndexer xapindexer;
+	SharedXapResults xapresults;
 
 	// spellcheck
 	SharedJam jamdb;
@@ -115,6 +136,9 @@ public:
 	// xapian dont use
 	SharedBool no_xapian;
 
+	// xapian run importance ordered profile rules in one pass
+	SharedBool fuse_rules;
+
 #endif
 
 	// counter shared
@@ -129,6 +153,9 @@ public:
 	SharedCache dbcache;
 	SharedCache tmpcache;
 
+	// checked session keys , null if off
+	SharedSessions sesscache;
+
 	// booleans
 	SharedBool is_master;
 	SharedBool is_ready;
@@ -140,6 +167,13 @@ public:
 	SharedUnsigned max_fetch_records;
 	SharedUnsigned max_user_sessions;
 
+	// http persistent connection idle seconds , response compression
+	SharedUnsigned http_keep_alive;
+	SharedHttpCompress httpcompress;
+
+	// bounded request queues by traffic class
+	SharedScheduler reqsched;
+
 	// queue
 	// JobQueue jobqueue;
 
@@ -75,6 +75,20 @@ public:
 	*/
 	static std::vector<std::string> Regex(const std::string& input, const boost::regex reg, bool trim=false);
 
+	/**
+	* Box : split a geometry like BOX(x1 y1,x2 y2) into its four numbers , without regex
+	*
+	* @param input
+	*   const std::string& input geometry
+	*
+	* @param extent
+	*   std::vector<double>& extent to fill , cleared if not a box
+	*
+	* @return
+	*   bool true if a box
+	*/
+	static bool Box(const std::string& input, std::vector<double>& extent);
+
 };
 
 } // namespace utils
@@ -0,0 +1,73 @@
+/**
+ * @project zapdos
+ * @file include/utils/ThreadPin.hpp
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ThreadPin.hpp : Pin threads to cpu sets or numa nodes Headers
+ *
+ */
+#ifndef _ZPDS_UTILS_THREAD_PIN_HPP_
+#define _ZPDS_UTILS_THREAD_PIN_HPP_
+
+#include <string>
+#include <vector>
+
+namespace zpds {
+namespace utils {
+
+class ThreadPin {
+public:
+	using CpuListT = std::vector<unsigned int>;
+
+	/**
+	* Parse : cpus from a list like 0-3,8 , a numa node as node1 takes its cpus
+	*
+	* @param input
+	*   const std::string& input cpu list
+	*
+	* @return
+	*   CpuListT empty if input empty , throws ConfigException if bad
+	*/
+	static CpuListT Parse(const std::string& input);
+
+	/**
+	* PinSelf : pin the calling thread to cpus , threads it starts later inherit it
+	*
+	* @param cpus
+	*   const CpuListT& cpus , empty is no change
+	*
+	* @return
+	*   bool false if not pinned
+	*/
+	static bool PinSelf(const CpuListT& cpus);
+
+};
+
+} // namespace utils
+} // namespace zpds
+
+#endif // _ZPDS_UTILS_THREAD_PIN_HPP_
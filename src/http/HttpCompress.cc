@@ -0,0 +1,204 @@
+/**
+ * @project zapdos
+ * @file src/http/HttpCompress.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  HttpCompress.cc : Gzip and deflate of response bodies
+ *
+ */
+#include <cstdlib>
+#include <vector>
+#include <functional>
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include "http/HttpCompress.hpp"
+
+/**
+* Constructor : default
+*
+*/
+zpds::http::HttpCompress::HttpCompress(size_t threshold_, int level_, size_t cache_items_)
+	: threshold(threshold_),
+	  level( (level_ < 1) ? 1 : (level_ > 9) ? 9 : level_ ),
+	  cache_items(cache_items_),
+	  compressed(0),
+	  cache_hits(0),
+	  bytes_in(0),
+	  bytes_out(0)
+{
+}
+
+/**
+* destructor
+*/
+zpds::http::HttpCompress::~HttpCompress () {}
+
+/**
+* Accepts : encoding to use from the Accept-Encoding header , gzip preferred
+*
+*/
+zpds::http::HttpCompress::EncodingE zpds::http::HttpCompress::Accepts(const CaseInsensitiveMultimap& header)
+{
+	auto it = header.find("Accept-Encoding");
+	if (it == header.end()) return ENC_NONE;
+
+	bool gzip = false;
+	bool deflate = false;
+	std::vector<std::string> codings;
+	boost::algorithm::split(codings, it->second, boost::algorithm::is_any_of(","));
+	for (auto& coding : codings) {
+		std::vector<std::string> parts;
+		boost::algorithm::split(parts, coding, boost::algorithm::is_any_of(";"));
+		std::string name = boost::algorithm::trim_copy(parts[0]);
+		boost::algorithm::to_lower(name);
+
+		// q=0 is not acceptable
+		bool refused = false;
+		for (size_t i = 1 ; i < parts.size() ; ++i) {
+			std::string param = boost::algorithm::trim_copy(parts[i]);
+			if (param.length() > 2 && (param[0]=='q' || param[0]=='Q') && param[1]=='=')
+				refused = ( std::strtod(param.c_str() + 2, nullptr) <= 0 );
+		}
+		if (refused) continue;
+		if (name=="gzip" || name=="x-gzip" || name=="*") gzip = true;
+		else if (name=="deflate") deflate = true;
+	}
+	return (gzip) ? ENC_GZIP : (deflate) ? ENC_DEFLATE : ENC_NONE;
+}
+
+/**
+* GetName : Content-Encoding value
+*
+*/
+const char* zpds::http::HttpCompress::GetName(EncodingE enc)
+{
+	return (enc==ENC_GZIP) ? "gzip" : (enc==ENC_DEFLATE) ? "deflate" : "identity";
+}
+
+/**
+* Compress : compressed body if long enough , from the kept ones if there
+*
+*/
+zpds::http::HttpCompress::BodyT zpds::http::HttpCompress::Compress(const std::string& payload, EncodingE enc)
+{
+	if (enc==ENC_NONE || threshold==0 || payload.length() < threshold) return nullptr;
+
+	const bool keep = ( cache_items > 0 && payload.length() <= ZPDS_HTTP_COMPRESS_CACHE_MAXLEN );
+	const size_t key = std::hash<std::string>()(payload) ^ (size_t)enc;
+	if (keep) {
+		std::lock_guard<std::mutex> lock(cache_lock);
+		auto it = cache.find(key);
+		if (it != cache.end() && it->second.payload == payload) {
+			++cache_hits;
+			bytes_in += payload.length();
+			bytes_out += it->second.body->length();
+			return it->second.body;
+		}
+	}
+
+	BodyT body = std::make_shared<const std::string>( Deflate(payload, enc) );
+	++compressed;
+	bytes_in += payload.length();
+	bytes_out += body->length();
+
+	if (keep) {
+		std::lock_guard<std::mutex> lock(cache_lock);
+		auto ret = cache.emplace(key, EntryT{payload, body});
+		if (ret.second) {
+			order.push_back(key);
+			while (order.size() > cache_items) {
+				cache.erase(order.front());
+				order.pop_front();
+			}
+		}
+		else {
+			// same hash , newer wins , order unchanged
+			ret.first->second = EntryT{payload, body};
+		}
+	}
+	return body;
+}
+
+/**
+* Deflate : compress with zlib
+*
+*/
+std::string zpds::http::HttpCompress::Deflate(const std::string& payload, EncodingE enc) const
+{
+	std::string out;
+	out.reserve( payload.length() / 2 + 64 );
+	{
+		boost::iostreams::filtering_ostream os;
+		if (enc==ENC_GZIP)
+			os.push( boost::iostreams::gzip_compressor( boost::iostreams::gzip_params(level) ) );
+		else
+			os.push( boost::iostreams::zlib_compressor( boost::iostreams::zlib_params(level) ) );
+		os.push( boost::iostreams::back_inserter(out) );
+		os.write( payload.data(), payload.length() );
+	}
+	return out;
+}
+
+/**
+* GetCompressed : bodies compressed
+*
+*/
+uint64_t zpds::http::HttpCompress::GetCompressed() const
+{
+	return compressed.load();
+}
+
+/**
+* GetCacheHits : bodies sent precompressed
+*
+*/
+uint64_t zpds::http::HttpCompress::GetCacheHits() const
+{
+	return cache_hits.load();
+}
+
+/**
+* GetBytesIn : uncompressed bytes of bodies sent compressed
+*
+*/
+uint64_t zpds::http::HttpCompress::GetBytesIn() const
+{
+	return bytes_in.load();
+}
+
+/**
+* GetBytesOut : compressed bytes sent
+*
+*/
+uint64_t zpds::http::HttpCompress::GetBytesOut() const
+{
+	return bytes_out.load();
+}
@@ -65,6 +65,8 @@ void zpds::http::WebServer::init(zpds::utils::ServerBase::ParamsListT params)
 	server = std::make_shared<HttpServerT>( std::stoul(params[1]) );
 	server->config.address=params[0];
 	server->io_whatever = io_whatever;
+	server->config.timeout_keep_alive = sharedtable->http_keep_alive.Get();
+	server->config.compress = sharedtable->httpcompress;
 	is_init=true;
 	DLOG(INFO) << "WebServer init 1 here" << std::endl;
 	{
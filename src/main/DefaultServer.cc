@@ -37,6 +37,7 @@
 #include <glog/logging.h>
 #include <iostream>
 #include <functional>
+#include <thread>
 
 /* GFlags Start */
 DEFINE_bool(h, false, "Show help");
@@ -69,6 +70,7 @@ DEFINE_bool(no_xapian, false, "Flag to prevent search index");
 
 #include "utils/CfgFileOptions.hpp"
 #include "utils/SharedTable.hpp"
+#include "utils/ThreadPin.hpp"
 
 #include "DefaultServer.hh"
 #include "WorkServer.hpp"
@@ -170,6 +172,61 @@ int main(int argc, char *argv[])
 		uint64_t max_user_sessions = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_SYSTEM, "max_user_sessions", true); // no throw
 		stptr->max_user_sessions.Set( (max_user_sessions>0 && max_user_sessions<10) ? max_user_sessions : 5 );
 
+		// keep_alive_timeout default 0 same as request timeout
+		stptr->http_keep_alive.Set( MyCFG->Find<uint64_t>(wbs_section, "keep_alive_timeout", true) ); // no throw
+
+		// gzip_threshold default 0 no compression
+		uint64_t gzip_threshold = MyCFG->Find<uint64_t>(wbs_section, "gzip_threshold", true); // no throw
+		if (gzip_threshold>0) {
+			int gzip_level = MyCFG->Find<int>(wbs_section, "gzip_level", true); // no throw
+			uint64_t gzip_cache = MyCFG->Check(wbs_section, "gzip_cache")
+			                      ? MyCFG->Find<uint64_t>(wbs_section, "gzip_cache", true) : ZPDS_HTTP_COMPRESS_CACHE;
+			stptr->httpcompress = ::zpds::http::HttpCompress::Create( gzip_threshold,
+			                      (gzip_level>0) ? gzip_level : ZPDS_HTTP_COMPRESS_LEVEL, gzip_cache );
+		}
+
+		// dbcache memory default 128 MB , 0 no limit , tmpcache is never limited
+		uint64_t dbcache_mb = MyCFG->Check(ZPDS_DEFAULT_STRN_WORK, "dbcache_mb")
+		                      ? MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "dbcache_mb", true) : ZPDS_CACHE_DEFAULT_MB;
+		uint64_t dbcache_shards = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "dbcache_shards", true); // no throw
+		stptr->dbcache = ::zpds::store::CacheContainer::create( dbcache_mb * 1024 * 1024,
+		                 (dbcache_shards>0) ? dbcache_shards : ZPDS_CACHE_DEFAULT_SHARDS );
+
+		// session_cache users with checked session keys default 10000 , 0 is off
+		uint64_t session_cache = MyCFG->Check(ZPDS_DEFAULT_STRN_WORK, "session_cache")
+		                         ? MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "session_cache", true) : ZPDS_SESSION_CACHE_USERS;
+		if (session_cache>0)
+			stptr->sesscache = ::zpds::store::SessionCache::Create( session_cache, stptr->max_user_sessions.Get() );
+
+		// async++ default pool threads start on first use and copy the cpu mask of that
+		// thread , start them here before any thread is pinned
+		async::default_threadpool_scheduler();
+
+		// io threads running accept , read and write of both servers , default 1
+		uint64_t io_threads = MyCFG->Find<uint64_t>(wbs_section, "io_threads", true); // no throw
+		if (io_threads==0) io_threads=1;
+		auto io_cpus = ::zpds::utils::ThreadPin::Parse( MyCFG->Find<std::string>(wbs_section, "io_cpus", true) ); // no throw
+
+		// request threads , queue , deadline and cpus by class , zero or empty takes default
+		::zpds::utils::RequestScheduler::ParamsListT sched_params(::zpds::utils::RequestScheduler::REQ_CLASSES);
+		auto& search_params = sched_params[::zpds::utils::RequestScheduler::REQ_QUERY];
+		search_params.threads = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "search_threads", true); // no throw
+		search_params.queue = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "search_queue", true); // no throw
+		search_params.deadline_ms = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "search_deadline_ms", true); // no throw
+		search_params.cpus = ::zpds::utils::ThreadPin::Parse( MyCFG->Find<std::string>(ZPDS_DEFAULT_STRN_WORK, "search_cpus", true) ); // no throw
+		if (search_params.threads==0) search_params.threads = std::max(2u, std::thread::hardware_concurrency());
+		auto& admin_params = sched_params[::zpds::utils::RequestScheduler::REQ_ADMIN];
+		admin_params.threads = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "admin_threads", true); // no throw
+		admin_params.queue = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "admin_queue", true); // no throw
+		admin_params.deadline_ms = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_WORK, "admin_deadline_ms", true); // no throw
+		admin_params.cpus = ::zpds::utils::ThreadPin::Parse( MyCFG->Find<std::string>(ZPDS_DEFAULT_STRN_WORK, "admin_cpus", true) ); // no throw
+		auto& hrpc_params = sched_params[::zpds::utils::RequestScheduler::REQ_HRPC];
+		hrpc_params.threads = MyCFG->Find<uint64_t>(wcs_section, "threads", true); // no throw
+		hrpc_params.queue = MyCFG->Find<uint64_t>(wcs_section, "queue", true); // no throw
+		hrpc_params.deadline_ms = MyCFG->Find<uint64_t>(wcs_section, "deadline_ms", true); // no throw
+		hrpc_params.cpus = ::zpds::utils::ThreadPin::Parse( MyCFG->Find<std::string>(wcs_section, "cpus", true) ); // no throw
+		stptr->reqsched = ::zpds::utils::RequestScheduler::Create(sched_params);
+
 		// uint64_t currtime = ZPDS_CURRTIME_MS;
 		/** Local Strings START */
 
@@ -178,7 +235,37 @@ int main(int argc, char *argv[])
 		if (xapath.empty()) throw zpds::InitialException("xapian/xapath is needed");
 		if (!boost::filesystem::exists(xapath)) boost::filesystem::create_directories(xapath);
 		stptr->xapath.Set( xapath );
-		stptr->xapdb = ::zpds::search::WriteIndex::Create(xapath);
+		// xapian shards per index default 1 , changing needs reindex
+		uint64_t xapshards = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "shards", true); // no throw
+		stptr->xapdb = ::zpds::search::WriteIndex::Create(xapath, (xapshards>0) ? xapshards : 1 );
+		// max length of partial words indexed default 0 is all , changing it needs a reindex
+		uint64_t part_limit = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "part_limit", true); // no throw
+		::zpds::search::BaseUtils::SetPartLimit( part_limit );
+
+		// reader pool idle handles per index default 16 , geo_column default off , prefix top documents off if depth 0
+		uint64_t reader_pool_idle = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "reader_pool_idle", true); // no throw
+		int geo_column = MyCFG->Find<int>(ZPDS_DEFAULT_STRN_XAPIAN, "geo_column", true); // no throw
+		::zpds::search::PrefixTopK::ParamsT prefix_params;
+		prefix_params.depth = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "prefix_depth", true); // no throw
+		uint64_t prefix_items = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "prefix_items", true); // no throw
+		if (prefix_items>0) prefix_params.items = prefix_items;
+		prefix_params.geo = ( MyCFG->Find<int>(ZPDS_DEFAULT_STRN_XAPIAN, "prefix_geo", true) > 0 ); // no throw
+		stptr->xappool = ::zpds::search::ReaderPool::Create(xapath, stptr->xapdb,
+		                 (reader_pool_idle>0) ? reader_pool_idle : ZPDS_READER_POOL_MAX_IDLE, (geo_column>0), prefix_params );
+
+		// commit scheduler limits , zero takes defaults
+		::zpds::search::CommitScheduler::LimitsT commit_limits {
+			MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "commit_docs", true), // no throw
+			MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "commit_ms", true), // no throw
+			MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "commit_bytes", true), // no throw
+			MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "commit_wait_ms", true) // no throw
+		};
+		stptr->xapcommit = ::zpds::search::CommitScheduler::Create(stptr->xapdb, commit_limits);
+
+		// index pipeline , zero takes defaults
+		uint64_t index_threads = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "index_threads", true); // no throw
+		uint64_t index_queue = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "index_queue", true); // no throw
+		stptr->xapindexer = ::zpds::search::IndexPipeline::Create(stptr->xapdb, stptr->xapcommit, index_threads, index_queue);
 
 		// spellcheck store jampath
 		std::string jampath = MyCFG->Find<std::string>(ZPDS_DEFAULT_STRN_XAPIAN, "jampath");
@@ -193,6 +280,19 @@ int main(int argc, char *argv[])
 
 		// no_xapian flag
 		stptr->no_xapian.Set ( FLAGS_no_xapian );
+
+		// completion result cache , off if result_cache_mb is zero
+		uint64_t result_cache_mb = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "result_cache_mb", true); // no throw
+		if (result_cache_mb>0) {
+			uint64_t result_cache_ttl_ms = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "result_cache_ttl_ms", true); // no throw
+			uint64_t result_cache_shards = MyCFG->Find<uint64_t>(ZPDS_DEFAULT_STRN_XAPIAN, "result_cache_shards", true); // no throw
+			stptr->xapresults = ::zpds::search::ResultCache::Create( result_cache_mb * 1024 * 1024,
+			                    result_cache_ttl_ms, result_cache_shards );
+		}
+
+		// fuse_rules default off
+		int fuse_rules = MyCFG->Find<int>(ZPDS_DEFAULT_STRN_XAPIAN, "fuse_rules", true); // no throw
+		stptr->fuse_rules.Set( fuse_rules >0 );
 #endif
 
 		// datadir
@@ -271,13 +371,30 @@ int main(int argc, char *argv[])
 				std::this_thread::sleep_for( std::chrono::milliseconds( 1000 ) );
 				tmp_csize = stptr->tmpcache->AssocSize();
 			}
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+			// drain queued index changes , then final commit
+			if (stptr->xapindexer) stptr->xapindexer->Stop();
+			if (stptr->xapcommit) stptr->xapcommit->Stop();
+#endif
 			wcs->stop();
 			wbs->stop();
+			// answer what is queued before io stops
+			if (stptr->reqsched) stptr->reqsched->Stop();
 			m_io_whatever->stop();
 		}
 		);
 		stptr->is_ready.Set( true );
+		// this thread is one of the io threads
+		std::vector<std::thread> io_pool;
+		for (uint64_t i=1 ; i < io_threads ; ++i) {
+			io_pool.emplace_back( std::thread([m_io_whatever,io_cpus] {
+				::zpds::utils::ThreadPin::PinSelf(io_cpus);
+				m_io_whatever->run();
+			}) );
+		}
+		::zpds::utils::ThreadPin::PinSelf(io_cpus);
 		m_io_whatever->run();
+		for (auto& t : io_pool) t.join();
 		/** Interrupted */
 		DLOG(INFO) << "IO Stopped" << std::endl;
 
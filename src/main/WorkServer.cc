@@ -113,6 +113,10 @@ void zpds::work::WorkServer::init(zpds::utils::ServerBase::ParamsListT params)
 
 		// if resets last_lkey
 		sharedtable->logcounter.Set ( (last_lkey>0) ? last_lkey : 0 );
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+		// index pipeline applies log ids after this in order
+		if (sharedtable->xapindexer) sharedtable->xapindexer->SetWatermark( sharedtable->logcounter.Get() );
+#endif
 
 		uint64_t currtime = ZPDS_CURRTIME_MS;
 
@@ -149,7 +153,7 @@ void zpds::work::WorkServer::init(zpds::utils::ServerBase::ParamsListT params)
 
 #ifdef ZPDS_BUILD_WITH_XAPIAN
 		if (FLAGS_warmcache) {
-			std::string xapath = sharedtable->xapath.Get();
+			auto xappool = sharedtable->xappool;
 
 			// collect the ids from index
 			const google::protobuf::EnumDescriptor *l = ::zpds::search::LangTypeE_descriptor();
@@ -157,8 +161,8 @@ void zpds::work::WorkServer::init(zpds::utils::ServerBase::ParamsListT params)
 			for (auto i=0 ; i < l->value_count() ; ++i ) {
 				for (auto j=0 ; j < d->value_count() ; ++j ) {
 					LOG(INFO) << "Warming cache : " << l->value(i)->name() << "_" << d->value(j)->name() ;
-					async::parallel_for(async::irange(0, 9), [xapath,i,j](size_t k) {
-						::zpds::search::SearchCache trie( xapath );
+					async::parallel_for(async::irange(0, 9), [xappool,i,j](size_t k) {
+						::zpds::search::SearchCache trie( xappool );
 						trie.WarmCache( ::zpds::search::LangTypeE(i),::zpds::search::IndexTypeE(j),k,10);
 					});
 				}
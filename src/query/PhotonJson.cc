@@ -0,0 +1,357 @@
+/**
+ * @project zapdos
+ * @file src/query/PhotonJson.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PhotonJson.cc : Schema specific json writer for search responses
+ *
+ */
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+
+#include "query/PhotonJson.hpp"
+
+namespace {
+
+/**
+* JsonHex : append \uXXXX for a utf-16 unit
+*
+*/
+inline void JsonHex(std::string& str, uint32_t cp)
+{
+	static const char hex[] = "0123456789abcdef";
+	char buf[6] = { '\\', 'u', hex[(cp>>12)&0xf], hex[(cp>>8)&0xf], hex[(cp>>4)&0xf], hex[cp&0xf] };
+	str.append(buf, 6);
+}
+
+/**
+* JsonMustEscape : non ascii code points the protobuf json printer escapes
+*
+*/
+inline bool JsonMustEscape(uint32_t cp)
+{
+	return (cp>=0x80 && cp<=0x9f) || cp==0xad
+	       || (cp>=0x600 && cp<=0x603) || cp==0x6dd || cp==0x70f
+	       || cp==0x17b4 || cp==0x17b5
+	       || (cp>=0x200b && cp<=0x200f) || (cp>=0x2028 && cp<=0x202e)
+	       || (cp>=0x2060 && cp<=0x2064) || (cp>=0x206a && cp<=0x206f)
+	       || cp==0xfeff || (cp>=0xfff9 && cp<=0xfffb)
+	       || (cp>=0x1d173 && cp<=0x1d17a)
+	       || cp==0xe0001 || (cp>=0xe0020 && cp<=0xe007f);
+}
+
+/**
+* JsonString : append quoted and escaped string
+*
+* @return
+*   bool false if not valid utf-8 , left to pb2json
+*/
+inline bool JsonString(std::string& str, const std::string& in)
+{
+	str.push_back('"');
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(in.data());
+	const unsigned char* e = p + in.size();
+	const unsigned char* run = p;
+	while (p < e) {
+		unsigned char c = *p;
+		if (c < 0x80) {
+			const char* esc = nullptr;
+			switch (c) {
+			case '"' : esc = "\\\""; break;
+			case '\\': esc = "\\\\"; break;
+			case '\b': esc = "\\b"; break;
+			case '\f': esc = "\\f"; break;
+			case '\n': esc = "\\n"; break;
+			case '\r': esc = "\\r"; break;
+			case '\t': esc = "\\t"; break;
+			default: break;
+			}
+			if ( esc || c < 0x20 || c=='<' || c=='>' || c==0x7f ) {
+				str.append(reinterpret_cast<const char*>(run), p - run);
+				if (esc) str.append(esc);
+				else JsonHex(str, c);
+				run = ++p;
+			}
+			else ++p;
+			continue;
+		}
+
+		// multibyte , only valid shortest forms
+		uint32_t cp = 0;
+		size_t len = 0;
+		if (c >= 0xc2 && c <= 0xdf) { cp = c & 0x1f; len = 2; }
+		else if (c >= 0xe0 && c <= 0xef) { cp = c & 0x0f; len = 3; }
+		else if (c >= 0xf0 && c <= 0xf4) { cp = c & 0x07; len = 4; }
+		else return false;
+		if ( (size_t)(e - p) < len ) return false;
+		for (size_t i = 1 ; i < len ; ++i) {
+			if ( (p[i] & 0xc0) != 0x80 ) return false;
+			cp = (cp << 6) | (p[i] & 0x3f);
+		}
+		if ( (len==3 && (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff))) || (len==4 && (cp < 0x10000 || cp > 0x10ffff)) )
+			return false;
+
+		if ( JsonMustEscape(cp) ) {
+			str.append(reinterpret_cast<const char*>(run), p - run);
+			if (cp > 0xffff) {
+				cp -= 0x10000;
+				JsonHex(str, 0xd800 + (cp >> 10));
+				JsonHex(str, 0xdc00 + (cp & 0x3ff));
+			}
+			else JsonHex(str, cp);
+			p += len;
+			run = p;
+		}
+		else p += len;
+	}
+	str.append(reinterpret_cast<const char*>(run), p - run);
+	str.push_back('"');
+	return true;
+}
+
+/**
+* JsonShortDouble : fixed notation if some decimal of upto 15 digits reads back as d ,
+*   then that is what %.15g prints as the 15 digit grid has only one point that near
+*
+* @return
+*   bool false if not , left to snprintf
+*/
+inline bool JsonShortDouble(std::string& str, double d)
+{
+	static const double p10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+	                              1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19
+	                            };
+	const double a = std::fabs(d);
+	if ( !(a >= 1e-4 && a < 1e15) ) return false;
+
+	for (int k = 0 ; k < 20 ; ++k) {
+		const double scaled = a * p10[k];
+		if ( scaled >= 1e15 ) return false;
+		const uint64_t m = (uint64_t) std::llround(scaled);
+		if ( (double)m / p10[k] != a ) continue;
+
+		char buf[40];
+		char* e = buf + sizeof(buf);
+		char* p = e;
+		uint64_t ip = m;
+		if (k > 0) {
+			// fraction without trailing zeros
+			uint64_t fp = m;
+			int digits = k;
+			while ( digits > 0 && fp % 10 == 0 ) {
+				fp /= 10;
+				--digits;
+			}
+			for (int i = 0 ; i < k ; ++i) ip /= 10;
+			if (digits > 0) {
+				for (int i = 0 ; i < digits ; ++i) {
+					*--p = '0' + (fp % 10);
+					fp /= 10;
+				}
+				*--p = '.';
+			}
+		}
+		do {
+			*--p = '0' + (ip % 10);
+			ip /= 10;
+		} while (ip > 0);
+		if (d < 0) *--p = '-';
+		str.append(p, e - p);
+		return true;
+	}
+	return false;
+}
+
+/**
+* JsonDouble : append double as protobuf prints it , %.15g if that reads back else %.17g
+*
+*/
+inline void JsonDouble(std::string& str, double d)
+{
+	if (std::isnan(d)) { str.append("\"NaN\""); return; }
+	if (std::isinf(d)) { str.append( (d > 0) ? "\"Infinity\"" : "\"-Infinity\"" ); return; }
+	if (JsonShortDouble(str, d)) return;
+	char buf[32];
+	int n = std::snprintf(buf, sizeof(buf), "%.*g", DBL_DIG, d);
+	if ( std::strtod(buf, nullptr) != d )
+		n = std::snprintf(buf, sizeof(buf), "%.*g", DBL_DIG+2, d);
+	str.append(buf, n);
+}
+
+/**
+* JsonKey : append separator and key
+*
+*/
+inline void JsonKey(std::string& str, bool& first, const char* key)
+{
+	if (!first) str.push_back(',');
+	first = false;
+	str.push_back('"');
+	str.append(key);
+	str.append("\":");
+}
+
+/**
+* JsonField : append string field if not blank
+*
+*/
+inline bool JsonField(std::string& str, bool& first, const char* key, const std::string& value)
+{
+	if (value.empty()) return true;
+	JsonKey(str, first, key);
+	return JsonString(str, value);
+}
+
+/**
+* JsonDoubles : append repeated double field if not blank
+*
+*/
+inline void JsonDoubles(std::string& str, bool& first, const char* key,
+                        const ::google::protobuf::RepeatedField<double>& values)
+{
+	if (values.size()==0) return;
+	JsonKey(str, first, key);
+	str.push_back('[');
+	for (auto i = 0 ; i < values.size() ; ++i) {
+		if (i>0) str.push_back(',');
+		JsonDouble(str, values.Get(i));
+	}
+	str.push_back(']');
+}
+
+/**
+* PhotonFeature : append one feature
+*
+*/
+inline bool PhotonFeature(std::string& str, const ::zpds::search::PhotonDataT& feat)
+{
+	bool first = true;
+	str.push_back('{');
+	if (!JsonField(str, first, "type", feat.type())) return false;
+
+	if (feat.has_properties()) {
+		const auto& prop = feat.properties();
+		JsonKey(str, first, "properties");
+		bool pfirst = true;
+		str.push_back('{');
+		if (prop.osm_id() != 0) {
+			JsonKey(str, pfirst, "osm_id");
+			str.push_back('"');
+			str.append(std::to_string(prop.osm_id()));
+			str.push_back('"');
+		}
+		if (!JsonField(str, pfirst, "osm_key", prop.osm_key())) return false;
+		if (!JsonField(str, pfirst, "osm_value", prop.osm_value())) return false;
+		if (!JsonField(str, pfirst, "osm_type", prop.osm_type())) return false;
+		if (!JsonField(str, pfirst, "city", prop.city())) return false;
+		if (!JsonField(str, pfirst, "country", prop.country())) return false;
+		if (!JsonField(str, pfirst, "state", prop.state())) return false;
+		if (!JsonField(str, pfirst, "name", prop.name())) return false;
+		if (!JsonField(str, pfirst, "address", prop.address())) return false;
+		if (!JsonField(str, pfirst, "postcode", prop.postcode())) return false;
+		if (!JsonField(str, pfirst, "area", prop.area())) return false;
+		JsonDoubles(str, pfirst, "extent", prop.extent());
+		str.push_back('}');
+	}
+
+	if (feat.has_geometry()) {
+		const auto& geom = feat.geometry();
+		JsonKey(str, first, "geometry");
+		bool gfirst = true;
+		str.push_back('{');
+		if (!JsonField(str, gfirst, "type", geom.type())) return false;
+		JsonDoubles(str, gfirst, "coordinates", geom.coordinates());
+		str.push_back('}');
+	}
+	str.push_back('}');
+	return true;
+}
+
+} // namespace
+
+/**
+* photon2json : Convert photon result to json , same bytes as pb2json without reflection
+*
+*/
+void zpds::query::photon2json(const PhotonResultT* msg, std::string& str)
+{
+	const size_t start = str.length();
+	str.reserve( start + 64 + msg->features_size() * 512 );
+	bool first = true;
+	bool valid = true;
+	str.push_back('{');
+	valid = JsonField(str, first, "type", msg->type());
+	if ( valid && msg->features_size() > 0 ) {
+		JsonKey(str, first, "features");
+		str.push_back('[');
+		for (auto i = 0 ; valid && i < msg->features_size() ; ++i) {
+			if (i>0) str.push_back(',');
+			valid = PhotonFeature(str, msg->features(i));
+		}
+		str.push_back(']');
+	}
+	str.push_back('}');
+	if (valid) return;
+
+	// let protobuf handle what it escapes differently
+	str.resize(start);
+	str.append( pb2json(msg) );
+}
+
+/**
+* wiki2json : Convert wiki completion result to json , same bytes as pb2json without reflection
+*
+*/
+void zpds::query::wiki2json(const ItemResultT* msg, std::string& str)
+{
+	const size_t start = str.length();
+	str.reserve( start + 16 + msg->records_size() * 256 );
+	bool valid = true;
+	str.push_back('{');
+	if ( msg->records_size() > 0 ) {
+		str.append("\"records\":[");
+		for (auto i = 0 ; valid && i < msg->records_size() ; ++i) {
+			const auto& record = msg->records(i);
+			bool first = true;
+			if (i>0) str.push_back(',');
+			str.push_back('{');
+			valid = JsonField(str, first, "unique_id", record.unique_id())
+			        && JsonField(str, first, "title", record.title())
+			        && JsonField(str, first, "summary", record.summary());
+			str.push_back('}');
+		}
+		str.push_back(']');
+	}
+	str.push_back('}');
+	if (valid) return;
+
+	// let protobuf handle what it escapes differently
+	str.resize(start);
+	str.append( pb2json(msg) );
+}
@@ -32,7 +32,6 @@
  */
 #include "query/ProtoJson.hpp"
 #include <google/protobuf/util/json_util.h>
-#include <sstream>
 
 /**
 * pb2json : Convert protobuf to json
@@ -81,8 +80,13 @@ bool zpds::query::json2pb(const std::string& json, google::protobuf::Message* ms
 */
 std::string zpds::query::err2json(const int errorcode, const std::string error)
 {
-	std::stringstream ss;
-	ss << "{\"errorcode\":" << errorcode << ",\"error\":\"" << error << "\"}";
-	return ss.str();
+	std::string str;
+	str.reserve( 32 + error.length() );
+	str.append("{\"errorcode\":");
+	str.append( std::to_string(errorcode) );
+	str.append(",\"error\":\"");
+	str.append(error);
+	str.append("\"}");
+	return str;
 }
 
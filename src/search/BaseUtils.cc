@@ -35,6 +35,7 @@
 #include <iomanip>
 #include <cmath>
 #include <utility>
+#include <atomic>
 
 #include "search/BaseUtils.hpp"
 #include "utils/SplitWith.hpp"
@@ -42,6 +43,36 @@
 #include "search/KrovetzStemmer.hpp"
 thread_local ::stem::KrovetzStemmer stemmer;
 
+static std::atomic<size_t> part_limit{0};
+
+/**
+* SetPartLimit : set max length of partial words indexed
+*
+*/
+void zpds::search::BaseUtils::SetPartLimit(size_t limit)
+{
+	part_limit.store(limit);
+}
+
+/**
+* GetPartLimit : get max length of partial words indexed
+*
+*/
+size_t zpds::search::BaseUtils::GetPartLimit()
+{
+	return part_limit.load();
+}
+
+/**
+* OverPartLimit : check if a partial word is too long to be indexed as part
+*
+*/
+bool zpds::search::BaseUtils::OverPartLimit(const std::string& word)
+{
+	size_t limit = part_limit.load();
+	return ( limit > 0 && word.length() > limit );
+}
+
 /**
 * StemQuery : stem the query
 *
@@ -114,14 +145,15 @@ std::string zpds::search::BaseUtils::StemWord(const std::string& input) const
 std::string zpds::search::BaseUtils::NoSpace(const std::string& orig) const
 {
 	if (orig.empty()) return std::string();
-	std::ostringstream xtmp;
+	std::string xtmp;
+	xtmp.reserve( orig.length() );
 	std::locale loc;
 	for (auto i = orig.cbegin(), n = orig.cend(); i != n; ++i) {
 		auto c = (*i);
 		// if alnum lowercase into string
-		if (std::isalnum(c)) xtmp << std::tolower(c,loc);
+		if (std::isalnum(c)) xtmp.push_back( std::tolower(c,loc) );
 	}
-	return xtmp.str();
+	return xtmp;
 }
 
 /**
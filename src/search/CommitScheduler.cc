@@ -0,0 +1,193 @@
+/**
+ * @project zapdos
+ * @file src/search/CommitScheduler.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  CommitScheduler.cc : Background batched commits for WriteIndex impl
+ *
+ */
+#include "search/CommitScheduler.hpp"
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::CommitScheduler::CommitScheduler(WriteIndex::pointer writer_, LimitsT limits_)
+	: writer(writer_),
+	  limits( LimitsT{
+	           (limits_.max_docs>0) ? limits_.max_docs : XAP_COMMIT_DEFAULT_DOCS,
+	           (limits_.max_ms>0) ? limits_.max_ms : XAP_COMMIT_DEFAULT_MS,
+	           (limits_.max_bytes>0) ? limits_.max_bytes : XAP_COMMIT_DEFAULT_BYTES,
+	           (limits_.max_wait_ms>0) ? limits_.max_wait_ms : XAP_COMMIT_DEFAULT_WAIT_MS
+	       }),
+	  stopping(false), requested(false), commits(0), waits(0)
+{
+	if (!writer) throw zpds::InitialException("commit scheduler needs a writer");
+}
+
+/**
+ * Destructor : stops the thread
+ *
+ */
+zpds::search::CommitScheduler::~CommitScheduler()
+{
+	Stop();
+}
+
+/**
+* Start : start the commit thread
+*
+*/
+void zpds::search::CommitScheduler::Start()
+{
+	std::lock_guard<std::mutex> lock(sched_lock);
+	if (worker.joinable()) return;
+	stopping=false;
+	worker = std::thread(&CommitScheduler::Run, this);
+}
+
+/**
+* Stop : stop the commit thread after a final commit
+*
+*/
+void zpds::search::CommitScheduler::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(sched_lock);
+		if (!worker.joinable()) return;
+		stopping=true;
+	}
+	sched_cv.notify_all();
+	worker.join();
+}
+
+/**
+* Notify : wake the thread to check limits
+*
+*/
+void zpds::search::CommitScheduler::Notify()
+{
+	if (IsDue()) sched_cv.notify_one();
+}
+
+/**
+* RequestCommit : commit at the next wakeup
+*
+*/
+void zpds::search::CommitScheduler::RequestCommit()
+{
+	{
+		std::lock_guard<std::mutex> lock(sched_lock);
+		requested=true;
+	}
+	sched_cv.notify_one();
+}
+
+/**
+* WaitForRoom : backpressure
+*
+*/
+bool zpds::search::CommitScheduler::WaitForRoom()
+{
+	if (!IsFull()) return true;
+	++waits;
+	sched_cv.notify_one();
+	std::unique_lock<std::mutex> lock(sched_lock);
+	return room_cv.wait_for(lock, std::chrono::milliseconds(limits.max_wait_ms),
+	[this] { return stopping || !IsFull(); });
+}
+
+/**
+* GetCommits , GetWaits : counters
+*
+*/
+uint64_t zpds::search::CommitScheduler::GetCommits() const
+{
+	return commits.load();
+}
+
+uint64_t zpds::search::CommitScheduler::GetWaits() const
+{
+	return waits.load();
+}
+
+/**
+* Run : thread loop
+*
+*/
+void zpds::search::CommitScheduler::Run()
+{
+	const auto poll = std::chrono::milliseconds( std::min<uint64_t>(limits.max_ms, XAP_COMMIT_POLL_MS) );
+	std::unique_lock<std::mutex> lock(sched_lock);
+	while (true) {
+		sched_cv.wait_for(lock, poll, [this] { return stopping || requested || IsDue(); });
+		bool last = stopping;
+		if ( requested || IsDue() || (last && writer->GetPendingDocs()>0) ) {
+			requested=false;
+			lock.unlock();
+			try {
+				writer->CommitData();
+				++commits;
+			}
+			catch (Xapian::Error& e) {
+				LOG(ERROR) << "Commit failed (xap) : " << e.get_msg() << " " << e.get_description();
+			}
+			catch (std::exception& e) {
+				LOG(ERROR) << "Commit failed : " << e.what();
+			}
+			lock.lock();
+			room_cv.notify_all();
+		}
+		if (last) break;
+	}
+	room_cv.notify_all();
+}
+
+/**
+* IsDue : check if any limit is reached
+*
+*/
+bool zpds::search::CommitScheduler::IsDue() const
+{
+	uint64_t docs = writer->GetPendingDocs();
+	if (docs==0) return false;
+	if (docs >= limits.max_docs) return true;
+	if (writer->GetPendingBytes() >= limits.max_bytes) return true;
+	uint64_t since = writer->GetPendingSince();
+	uint64_t currtime = ZPDS_CURRTIME_MS;
+	return ( since>0 && currtime >= since + limits.max_ms );
+}
+
+/**
+* IsFull : check if pending changes are above high water
+*
+*/
+bool zpds::search::CommitScheduler::IsFull() const
+{
+	return ( writer->GetPendingDocs() >= XAP_COMMIT_HIGH_WATER * limits.max_docs
+	         || writer->GetPendingBytes() >= XAP_COMMIT_HIGH_WATER * limits.max_bytes );
+}
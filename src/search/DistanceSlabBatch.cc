@@ -0,0 +1,220 @@
+/**
+ * @project zapdos
+ * @file src/search/DistanceSlabBatch.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  DistanceSlabBatch.cc : Distance slab keys scored in batches over location columns impl
+ *
+ */
+#include <cmath>
+#include <algorithm>
+
+#include "search/DistanceSlabBatch.hpp"
+
+/**
+* KeepInBound : keep the number in bound
+*
+*/
+template <typename T>
+const inline T KeepInBound(T val, T min, T max)
+{
+	return (val > min) ? ( (val<max) ? val : max ) : min;
+}
+
+/**
+* ScoreLess : by key then docid , as xapian sorts on key
+*
+*/
+static inline bool ScoreLess(const zpds::search::DistanceSlabBatch::ScoreT& a, const zpds::search::DistanceSlabBatch::ScoreT& b)
+{
+	return (a.key < b.key) || ( a.key == b.key && a.did < b.did );
+}
+
+/**
+* CanUse : check if slabs are few enough
+*
+*/
+bool zpds::search::DistanceSlabBatch::CanUse(int slab_, int md)
+{
+	int s = KeepInBound<int>(slab_, 1, XAP_DSLAB_MAX_DISTANCE );
+	int m = KeepInBound<int>(md, 0, XAP_DSLAB_MAX_DISTANCE );
+	return (m / s) <= XAP_DSLAB_BATCH_MAX_SLABS;
+}
+
+/**
+* Constructor: default
+*
+*/
+zpds::search::DistanceSlabBatch::DistanceSlabBatch(
+    const Xapian::LatLongCoord& centre_,
+    int slab_,
+    int dd,
+    int md,
+    GeoColumn::pointer column_,
+    size_t items_)
+	: centre(centre_),
+	  slab( KeepInBound<int>(slab_, 1, XAP_DSLAB_MAX_DISTANCE ) ),
+	  defdist( KeepInBound<int>(dd, 0, XAP_DSLAB_MAX_DISTANCE ) ),
+	  maxdist( KeepInBound<int>(md, 0, XAP_DSLAB_MAX_DISTANCE ) ),
+	  column(column_),
+	  items(items_),
+	  kernel(centre_.latitude, centre_.longitude),
+	  metric(),
+	  keymaker(XAP_LATLON_POS, XAP_IMPORTANCE_POS, Xapian::LatLongCoords(centre_), slab_, dd, md),
+	  refined(0)
+{
+	// lround(d) reaches j*slab from d = j*slab - 0.5 , keymaker clamps at maxdist
+	for (int j=1 ; j*slab <= maxdist ; ++j)
+		hslab.push_back( HaversineKernel::ToH( j*slab - 0.5 ) );
+	dids.reserve(XAP_DSLAB_BATCH);
+	rows.reserve(XAP_DSLAB_BATCH);
+	sinlat.reserve(XAP_DSLAB_BATCH);
+	coslat.reserve(XAP_DSLAB_BATCH);
+	sinlon.reserve(XAP_DSLAB_BATCH);
+	coslon.reserve(XAP_DSLAB_BATCH);
+	hout.resize(XAP_DSLAB_BATCH);
+}
+
+/**
+* Destructor: default
+*
+*/
+zpds::search::DistanceSlabBatch::~DistanceSlabBatch() {}
+
+/**
+* operator(): collect , always rejects
+*
+*/
+bool zpds::search::DistanceSlabBatch::operator()(const Xapian::Document& doc) const
+{
+	Xapian::docid did = doc.get_docid();
+	const GeoColumn::RowT* row = (column) ? column->Find(did) : nullptr;
+	if (!row) {
+		Push( Xapian::sortable_unserialise( keymaker(doc) ), did );
+	}
+	else if (row->state != XAP_GEOCOL_POINT) {
+		Push( Key( 1 + (defdist/slab), row->importance ), did );
+	}
+	else {
+		dids.push_back(did);
+		rows.push_back(row);
+		sinlat.push_back(row->sinlat);
+		coslat.push_back(row->coslat);
+		sinlon.push_back(row->sinlon);
+		coslon.push_back(row->coslon);
+		if (dids.size() >= XAP_DSLAB_BATCH) Flush();
+	}
+	return false;
+}
+
+/**
+* Finish: score pending and get top items
+*
+*/
+zpds::search::DistanceSlabBatch::ScoreVecT zpds::search::DistanceSlabBatch::Finish()
+{
+	Flush();
+	ScoreVecT out(heap);
+	std::sort(out.begin(), out.end(), ScoreLess);
+	return out;
+}
+
+/**
+* Slab: distance slab of a point from its haversine term
+*
+*/
+int zpds::search::DistanceSlabBatch::Slab(double h, const GeoColumn::RowT& row) const
+{
+	// chord 2R sqrt(h) is just under the distance , so the guess is at most a few slabs low
+	double guess = ( 2.0 * XAP_DKERNEL_RADIUS * std::sqrt( std::max(h, 0.0) ) + 0.5 ) / slab;
+	size_t j = (guess < hslab.size()) ? (size_t)guess : hslab.size();
+	while ( j < hslab.size() && h >= hslab[j] ) ++j;
+	while ( j > 0 && h < hslab[j-1] ) --j;
+	bool edge = ( j>0 && h - hslab[j-1] < XAP_DSLAB_BATCH_TOL ) || ( j<hslab.size() && hslab[j] - h < XAP_DSLAB_BATCH_TOL );
+	if (!edge) return 1 + j;
+	// too close to call , same metric as the keymaker
+	++refined;
+	double d = metric.pointwise_distance(centre, Xapian::LatLongCoord(row.lat, row.lon));
+	return 1 + ( KeepInBound<int>( std::lround(d), 0, maxdist) / slab );
+}
+
+/**
+* GetRefined: points decided by the exact metric
+*
+*/
+size_t zpds::search::DistanceSlabBatch::GetRefined() const
+{
+	return refined;
+}
+
+/**
+* Flush: score the pending block
+*
+*/
+void zpds::search::DistanceSlabBatch::Flush() const
+{
+	size_t n = dids.size();
+	if (n==0) return;
+	kernel.Haversine(sinlat.data(), coslat.data(), sinlon.data(), coslon.data(), n, hout.data());
+	for (size_t i=0 ; i<n ; ++i)
+		Push( Key( Slab(hout[i], *rows[i]), rows[i]->importance), dids[i] );
+	dids.clear();
+	rows.clear();
+	sinlat.clear();
+	coslat.clear();
+	sinlon.clear();
+	coslon.clear();
+}
+
+/**
+* Push: keep if in top items , heap has the worst on top
+*
+*/
+void zpds::search::DistanceSlabBatch::Push(double key, Xapian::docid did) const
+{
+	if (items==0) return;
+	ScoreT score{key, did};
+	if (heap.size() < items) {
+		heap.push_back(score);
+		std::push_heap(heap.begin(), heap.end(), ScoreLess);
+		return;
+	}
+	if ( !ScoreLess(score, heap.front()) ) return;
+	std::pop_heap(heap.begin(), heap.end(), ScoreLess);
+	heap.back() = score;
+	std::push_heap(heap.begin(), heap.end(), ScoreLess);
+}
+
+/**
+* Key: key from distance and importance
+*
+*/
+double zpds::search::DistanceSlabBatch::Key(int dslab, double importance) const
+{
+	double val_o = KeepInBound<double>( importance, 0, XAP_DSLAB_MAX_IMPORTANCE );
+	return (double)(dslab * XAP_DSLAB_MAX_IMPORTANCE) + (XAP_DSLAB_MAX_IMPORTANCE-val_o);
+}
@@ -66,14 +66,16 @@ zpds::search::DistanceSlabKeyMaker::DistanceSlabKeyMaker(
     Xapian::valueno slot_o_,
     const Xapian::LatLongCoords& centre_,
     int slab_,
-    int dd, int md)
+    int dd, int md,
+    GeoColumn::pointer column_)
 	: slot(slot_),
 	  slot_o(slot_o_),
 	  centre(centre_),
 	  metric(new Xapian::GreatCircleMetric()),
 	  slab( KeepInBound<int>(slab_, 1, XAP_DSLAB_MAX_DISTANCE ) ),
 	  defdist( KeepInBound<int>(dd, 0, XAP_DSLAB_MAX_DISTANCE ) ),
-	  maxdist( KeepInBound<int>(md, 0, XAP_DSLAB_MAX_DISTANCE ) )
+	  maxdist( KeepInBound<int>(md, 0, XAP_DSLAB_MAX_DISTANCE ) ),
+	  column( (slot_==XAP_LATLON_POS && slot_o_==XAP_IMPORTANCE_POS) ? column_ : nullptr )
 {}
 
 /**
@@ -92,6 +94,24 @@ zpds::search::DistanceSlabKeyMaker::~DistanceSlabKeyMaker()
 std::string zpds::search::DistanceSlabKeyMaker::operator()(const Xapian::Document& doc) const
 {
 
+	// decoded row if cached , same distance as the coords path for a single point
+	const GeoColumn::RowT* row = (column) ? column->Find( doc.get_docid() ) : nullptr;
+	if (row) {
+		int dist = defdist;
+		if (row->state == XAP_GEOCOL_POINT) {
+			Xapian::LatLongCoord point(row->lat, row->lon);
+			double mindist = -1.0;
+			for (auto it = centre.begin() ; it != centre.end() ; ++it) {
+				double d = metric->pointwise_distance(*it, point);
+				if (mindist < 0 || d < mindist) mindist = d;
+			}
+			if (mindist >= 0) dist = KeepInBound<int>( std::lround(mindist), 0, maxdist);
+		}
+		int dslab = 1+ (dist/slab);
+		double val_o = KeepInBound<double>( row->importance, 0, XAP_DSLAB_MAX_IMPORTANCE );
+		return Xapian::sortable_serialise( (double)(dslab * XAP_DSLAB_MAX_IMPORTANCE) + (XAP_DSLAB_MAX_IMPORTANCE-val_o) );
+	}
+
 	// handle dist as int32 faster
 	int dist = defdist;
 	std::string val_l(doc.get_value(slot));
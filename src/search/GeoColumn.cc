@@ -0,0 +1,187 @@
+/**
+ * @project zapdos
+ * @file src/search/GeoColumn.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  GeoColumn.cc : Docid indexed decoded location and importance columns impl
+ *
+ */
+#include <cmath>
+#include "search/GeoColumn.hpp"
+#include "search/HaversineKernel.hpp"
+
+using WorkBlockT = std::shared_ptr<::zpds::search::GeoColumn::BlockT>;
+using WorkVecT = std::vector<WorkBlockT>;
+
+/**
+* WorkRow : writable row , adds block if missing
+*
+*/
+static ::zpds::search::GeoColumn::RowT& WorkRow(WorkVecT& work, Xapian::docid did)
+{
+	size_t b = did / XAP_GEOCOL_BLOCK;
+	if ( b >= work.size() ) work.resize(b+1);
+	if ( !work[b] ) work[b] = std::make_shared<::zpds::search::GeoColumn::BlockT>();
+	return (*work[b])[ did % XAP_GEOCOL_BLOCK ];
+}
+
+/**
+* Build : build columns by streaming values
+*
+*/
+zpds::search::GeoColumn::pointer zpds::search::GeoColumn::Build(Xapian::Database& db, uint64_t generation)
+{
+	WorkVecT work;
+	size_t rows = 0;
+	// importance of a document without the value , as the keymaker would read it
+	const double noimportance = Xapian::sortable_unserialise( std::string() );
+
+	for (auto it = db.valuestream_begin(XAP_LATLON_POS) ; it != db.valuestream_end(XAP_LATLON_POS) ; ++it) {
+		RowT& row = WorkRow(work, it.get_docid());
+		Xapian::LatLongCoords coords;
+		coords.unserialise(*it);
+		// many points need the min distance , left to the document
+		if (coords.size()!=1) continue;
+		SetPoint(row, coords.begin()->latitude, coords.begin()->longitude);
+		row.importance = noimportance;
+		++rows;
+	}
+
+	for (auto it = db.valuestream_begin(XAP_IMPORTANCE_POS) ; it != db.valuestream_end(XAP_IMPORTANCE_POS) ; ++it) {
+		size_t b = it.get_docid() / XAP_GEOCOL_BLOCK;
+		if ( b >= work.size() || !work[b] ) continue;
+		RowT& row = (*work[b])[ it.get_docid() % XAP_GEOCOL_BLOCK ];
+		if ( row.state == XAP_GEOCOL_POINT ) row.importance = Xapian::sortable_unserialise(*it);
+	}
+
+	BlockVecT blocks( work.begin(), work.end() );
+	return std::make_shared<const GeoColumn>(generation, std::move(blocks), rows);
+}
+
+/**
+* Update : copy of prev with changed rows read again
+*
+*/
+zpds::search::GeoColumn::pointer zpds::search::GeoColumn::Update(
+    const pointer& prev, Xapian::Database& db, uint64_t generation, const IdTermsT& idterms)
+{
+	if (!prev) return Build(db, generation);
+
+	// blocks are shared with prev till written
+	BlockVecT blocks( prev->blocks );
+	WorkVecT owned( blocks.size() );
+	size_t rows = prev->rows;
+
+	for (auto& idterm : idterms) {
+		auto pit = db.postlist_begin(idterm);
+		// deleted , the old docid never matches again
+		if ( pit == db.postlist_end(idterm) ) continue;
+		Xapian::docid did = *pit;
+		size_t b = did / XAP_GEOCOL_BLOCK;
+		if ( b >= blocks.size() ) {
+			blocks.resize(b+1);
+			owned.resize(b+1);
+		}
+		if ( !owned[b] ) {
+			owned[b] = (blocks[b]) ? std::make_shared<BlockT>( *blocks[b] ) : std::make_shared<BlockT>();
+			blocks[b] = owned[b];
+		}
+		RowT& row = (*owned[b])[ did % XAP_GEOCOL_BLOCK ];
+		if ( row.state != XAP_GEOCOL_UNKNOWN ) --rows;
+		row = ReadRow( db.get_document(did) );
+		if ( row.state != XAP_GEOCOL_UNKNOWN ) ++rows;
+	}
+	return std::make_shared<const GeoColumn>(generation, std::move(blocks), rows);
+}
+
+/**
+* ReadRow : decode a row from document values
+*
+*/
+zpds::search::GeoColumn::RowT zpds::search::GeoColumn::ReadRow(const Xapian::Document& doc)
+{
+	RowT row;
+	row.importance = Xapian::sortable_unserialise( doc.get_value(XAP_IMPORTANCE_POS) );
+	std::string val_l( doc.get_value(XAP_LATLON_POS) );
+	if ( val_l.empty() ) {
+		row.state = XAP_GEOCOL_NOLOC;
+		return row;
+	}
+	Xapian::LatLongCoords coords;
+	coords.unserialise(val_l);
+	if ( coords.size()==1 ) {
+		SetPoint(row, coords.begin()->latitude, coords.begin()->longitude);
+	}
+	return row;
+}
+
+/**
+* SetPoint : set location of a row
+*
+*/
+void zpds::search::GeoColumn::SetPoint(RowT& row, double lat, double lon)
+{
+	row.lat = lat;
+	row.lon = lon;
+	row.sinlat = std::sin(lat * XAP_DKERNEL_DEG2RAD);
+	row.coslat = std::cos(lat * XAP_DKERNEL_DEG2RAD);
+	row.sinlon = std::sin(lon * XAP_DKERNEL_DEG2RAD);
+	row.coslon = std::cos(lon * XAP_DKERNEL_DEG2RAD);
+	row.state = XAP_GEOCOL_POINT;
+}
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::GeoColumn::GeoColumn(uint64_t generation_, BlockVecT&& blocks_, size_t rows_)
+	: generation(generation_), blocks(std::move(blocks_)), rows(rows_)
+{}
+
+/**
+ * Destructor : default
+ *
+ */
+zpds::search::GeoColumn::~GeoColumn() {}
+
+/**
+* GetGeneration : commit generation of the columns
+*
+*/
+uint64_t zpds::search::GeoColumn::GetGeneration() const
+{
+	return generation;
+}
+
+/**
+* GetRows : rows decoded
+*
+*/
+size_t zpds::search::GeoColumn::GetRows() const
+{
+	return rows;
+}
@@ -206,6 +206,35 @@ double zpds::search::GeoHashHelper::DistanceKm(double lat1, double lon1, double
 	return 2.0 * ZPDS_EARTH_RADIUS_KM * asin(sqrt(a));
 }
 
+/**
+* InnerRadiusM: min distance from point to the edge of the neighbour block
+*
+*/
+double zpds::search::GeoHashHelper::InnerRadiusM(double lat, double lon, std::string hash, size_t level) const
+{
+	if ( hash.length()==0 ) return 0.0;
+	zpds::search::GeoHashHelper::NewsT news = zpds::search::GeoHashHelper::Decode(hash).news;
+	if ( lat > news.north || lat < news.south || lon > news.east || lon < news.west ) return 0.0;
+
+	double height = news.north - news.south;
+	double width = news.east - news.west;
+
+	// cells in the block carry neighbour terms reaching level further out
+	double reach = 2.0 * level;
+	if ( news.north + reach * height > ZPDS_ALLOWED_MAX_LAT || news.south - reach * height < ZPDS_ALLOWED_MIN_LAT
+	        || news.east + reach * width >= ZPDS_ALLOWED_MAX_LON || news.west - reach * width <= ZPDS_ALLOWED_MIN_LON )
+		return 0.0;
+
+	double dlat = std::min( news.north + level * height - lat, lat - news.south + level * height );
+	double dlon = std::min( news.east + level * width - lon, lon - news.west + level * width );
+	if ( dlon >= 90.0 ) return 0.0;
+
+	// parallels are nearest along the meridian, meridians by cross track distance
+	double rlat = Deg2Rad(dlat) * ZPDS_EARTH_RADIUS_M;
+	double rlon = asin( cos(Deg2Rad(lat)) * sin(Deg2Rad(dlon)) ) * ZPDS_EARTH_RADIUS_M;
+	return std::min(rlat, rlon) * ZPDS_GEOHASH_SAFE_RATIO;
+}
+
 /**
 * GetBbox : get the hashes for a bbox
 *
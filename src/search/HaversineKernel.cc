@@ -0,0 +1,218 @@
+/**
+ * @project zapdos
+ * @file src/search/HaversineKernel.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  HaversineKernel.cc : Batch haversine terms with simd dispatch impl
+ *
+ */
+#include <cmath>
+#include "search/HaversineKernel.hpp"
+
+#if defined(__x86_64__) && ( defined(__GNUC__) || defined(__clang__) )
+#define XAP_DKERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+* With centre a and point b , both cos of differences come from sums of products
+*   cos(dlat) = cos(a)cos(b) + sin(a)sin(b)
+*   h = ( 1 - cos(dlat) )/2 + cos(a)cos(b) ( 1 - cos(dlon) )/2
+* so a point needs only multiplies and adds over its stored sin and cos.
+*
+*/
+
+/**
+* HaversineScalar : plain loop
+*
+*/
+static void HaversineScalar(double sa, double ca, double sl, double cl,
+                            const double* sinlat, const double* coslat, const double* sinlon, const double* coslon,
+                            size_t n, double* out)
+{
+	for (size_t i=0 ; i<n ; ++i) {
+		double cb = ca * coslat[i];
+		double cdlat = cb + sa * sinlat[i];
+		double cdlon = cl * coslon[i] + sl * sinlon[i];
+		out[i] = 0.5 * ( (1.0 - cdlat) + cb * (1.0 - cdlon) );
+	}
+}
+
+#ifdef XAP_DKERNEL_X86
+
+/**
+* HaversineSse4 : two points per step
+*
+*/
+__attribute__((target("sse4.1")))
+static void HaversineSse4(double sa, double ca, double sl, double cl,
+                          const double* sinlat, const double* coslat, const double* sinlon, const double* coslon,
+                          size_t n, double* out)
+{
+	const __m128d vsa = _mm_set1_pd(sa);
+	const __m128d vca = _mm_set1_pd(ca);
+	const __m128d vsl = _mm_set1_pd(sl);
+	const __m128d vcl = _mm_set1_pd(cl);
+	const __m128d one = _mm_set1_pd(1.0);
+	const __m128d half = _mm_set1_pd(0.5);
+	size_t i=0;
+	for ( ; i+2<=n ; i+=2) {
+		__m128d cb = _mm_mul_pd(vca, _mm_loadu_pd(coslat+i));
+		__m128d cdlat = _mm_add_pd(cb, _mm_mul_pd(vsa, _mm_loadu_pd(sinlat+i)));
+		__m128d cdlon = _mm_add_pd(_mm_mul_pd(vcl, _mm_loadu_pd(coslon+i)), _mm_mul_pd(vsl, _mm_loadu_pd(sinlon+i)));
+		__m128d h = _mm_add_pd(_mm_sub_pd(one, cdlat), _mm_mul_pd(cb, _mm_sub_pd(one, cdlon)));
+		_mm_storeu_pd(out+i, _mm_mul_pd(half, h));
+	}
+	HaversineScalar(sa, ca, sl, cl, sinlat+i, coslat+i, sinlon+i, coslon+i, n-i, out+i);
+}
+
+/**
+* HaversineAvx2 : four points per step
+*
+*/
+__attribute__((target("avx2,fma")))
+static void HaversineAvx2(double sa, double ca, double sl, double cl,
+                          const double* sinlat, const double* coslat, const double* sinlon, const double* coslon,
+                          size_t n, double* out)
+{
+	const __m256d vsa = _mm256_set1_pd(sa);
+	const __m256d vca = _mm256_set1_pd(ca);
+	const __m256d vsl = _mm256_set1_pd(sl);
+	const __m256d vcl = _mm256_set1_pd(cl);
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d half = _mm256_set1_pd(0.5);
+	size_t i=0;
+	for ( ; i+4<=n ; i+=4) {
+		__m256d cb = _mm256_mul_pd(vca, _mm256_loadu_pd(coslat+i));
+		__m256d cdlat = _mm256_fmadd_pd(vsa, _mm256_loadu_pd(sinlat+i), cb);
+		__m256d cdlon = _mm256_fmadd_pd(vsl, _mm256_loadu_pd(sinlon+i), _mm256_mul_pd(vcl, _mm256_loadu_pd(coslon+i)));
+		__m256d h = _mm256_fmadd_pd(cb, _mm256_sub_pd(one, cdlon), _mm256_sub_pd(one, cdlat));
+		_mm256_storeu_pd(out+i, _mm256_mul_pd(half, h));
+	}
+	HaversineScalar(sa, ca, sl, cl, sinlat+i, coslat+i, sinlon+i, coslon+i, n-i, out+i);
+}
+
+#endif // XAP_DKERNEL_X86
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::HaversineKernel::HaversineKernel(double lat, double lon)
+	: HaversineKernel(lat, lon, BestIsa())
+{}
+
+/**
+ * Constructor : with isa
+ *
+ */
+zpds::search::HaversineKernel::HaversineKernel(double lat, double lon, IsaE isa_)
+	: isa( (isa_ <= BestIsa()) ? isa_ : ISA_SCALAR ),
+	  sinlat( std::sin(lat * XAP_DKERNEL_DEG2RAD) ),
+	  coslat( std::cos(lat * XAP_DKERNEL_DEG2RAD) ),
+	  sinlon( std::sin(lon * XAP_DKERNEL_DEG2RAD) ),
+	  coslon( std::cos(lon * XAP_DKERNEL_DEG2RAD) )
+{}
+
+/**
+ * Destructor : default
+ *
+ */
+zpds::search::HaversineKernel::~HaversineKernel() {}
+
+/**
+* Haversine : haversine term h of n points
+*
+*/
+void zpds::search::HaversineKernel::Haversine(
+    const double* sinlat_, const double* coslat_, const double* sinlon_, const double* coslon_,
+    size_t n, double* out) const
+{
+	switch (isa) {
+#ifdef XAP_DKERNEL_X86
+	case ISA_AVX2:
+		HaversineAvx2(sinlat, coslat, sinlon, coslon, sinlat_, coslat_, sinlon_, coslon_, n, out);
+		break;
+	case ISA_SSE4:
+		HaversineSse4(sinlat, coslat, sinlon, coslon, sinlat_, coslat_, sinlon_, coslon_, n, out);
+		break;
+#endif
+	default:
+		HaversineScalar(sinlat, coslat, sinlon, coslon, sinlat_, coslat_, sinlon_, coslon_, n, out);
+		break;
+	}
+}
+
+/**
+* GetIsa : isa in use
+*
+*/
+zpds::search::HaversineKernel::IsaE zpds::search::HaversineKernel::GetIsa() const
+{
+	return isa;
+}
+
+/**
+* GetIsaName : isa in use as string
+*
+*/
+std::string zpds::search::HaversineKernel::GetIsaName() const
+{
+	switch (isa) {
+	case ISA_AVX2:
+		return "avx2";
+	case ISA_SSE4:
+		return "sse4";
+	default:
+		return "scalar";
+	}
+}
+
+/**
+* BestIsa : widest isa this cpu has
+*
+*/
+zpds::search::HaversineKernel::IsaE zpds::search::HaversineKernel::BestIsa()
+{
+#ifdef XAP_DKERNEL_X86
+	static const IsaE best = ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) ? ISA_AVX2
+	                         : ( __builtin_cpu_supports("sse4.1") ) ? ISA_SSE4 : ISA_SCALAR;
+	return best;
+#else
+	return ISA_SCALAR;
+#endif
+}
+
+/**
+* ToH : haversine term for a distance
+*
+*/
+double zpds::search::HaversineKernel::ToH(double dist)
+{
+	double s = std::sin( dist / (2.0 * XAP_DKERNEL_RADIUS) );
+	return s * s;
+}
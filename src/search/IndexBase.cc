@@ -108,8 +108,10 @@ void zpds::search::IndexBase::IndexWithPart (
 			}
 		}
 
-		// handle partial words
-		for (auto j=0; j< wvec.at(i).length() ; ++j) {
+		// handle partial words , longer ones are found by expanding full words
+		size_t plen = wvec.at(i).length();
+		if ( GetPartLimit() > 0 ) plen = std::min( plen, GetPartLimit() );
+		for (size_t j=0; j< plen ; ++j) {
 			doc.add_posting(part_prefix + wvec.at(i).substr(0,j+1), pos);
 		}
 	}
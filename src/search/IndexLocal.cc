@@ -35,6 +35,7 @@
 #include "search/IndexLocal.hpp"
 #include <boost/lexical_cast.hpp>
 #include "search/DistanceSlabKeyMaker.hpp"
+#include "search/PhotonProjection.hpp"
 #include "utils/SplitWith.hpp"
 #include "utils/PrintWith.hpp"
 #include <google/protobuf/descriptor.h>
@@ -121,6 +122,9 @@ Xapian::Document zpds::search::IndexLocal::CreateDoc(::zpds::store::ItemDataT* r
 	doc.add_value(XAP_ROCKSID_POS, std::to_string(record->id()));
 	doc.add_value(XAP_UNIQUEID_POS, record->unique_id());
 
+	// completions are served from this , not from the store
+	doc.set_data( PhotonProjection::Serialize( record ) );
+
 	DLOG(INFO) << " Before Write ms: " << ZPDS_CURRTIME_MS - currtime;
 
 	// write
@@ -0,0 +1,377 @@
+/**
+ * @project zapdos
+ * @file src/search/IndexPipeline.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  IndexPipeline.cc : Asynchronous indexing of committed transactions impl
+ *
+ */
+#include "search/IndexPipeline.hpp"
+#include "search/IndexLocal.hpp"
+#include "search/IndexWiki.hpp"
+
+const ::zpds::search::IndexLocal pipe_indexlocal;
+const ::zpds::search::IndexWiki pipe_indexwiki;
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::IndexPipeline::IndexPipeline(WriteIndex::pointer writer_, CommitScheduler::pointer sched_, size_t threads_, size_t capacity_)
+	: writer(writer_),
+	  sched(sched_),
+	  threads( (threads_>0) ? threads_ : XAP_INDEX_DEFAULT_THREADS ),
+	  capacity( (capacity_>0) ? capacity_ : XAP_INDEX_DEFAULT_QUEUE ),
+	  stopping(false), finishing(false), seeded(false), next_id(0),
+	  inflight(0), last_indexed(0), gaps(0), commit_at(0)
+{
+	if (!writer) throw zpds::InitialException("index pipeline needs a writer");
+}
+
+/**
+ * Destructor : stops the threads
+ *
+ */
+zpds::search::IndexPipeline::~IndexPipeline()
+{
+	Stop();
+}
+
+/**
+* Start : start builder and writer threads
+*
+*/
+void zpds::search::IndexPipeline::Start()
+{
+	std::lock_guard<std::mutex> lock(job_lock);
+	if (applier.joinable()) return;
+	stopping=false;
+	finishing=false;
+	for (size_t i=0 ; i < threads ; ++i)
+		builders.emplace_back( std::thread(&IndexPipeline::Build, this) );
+	applier = std::thread(&IndexPipeline::Apply, this);
+}
+
+/**
+* Stop : drain the queue and stop the threads
+*
+*/
+void zpds::search::IndexPipeline::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(job_lock);
+		if (!applier.joinable()) return;
+		stopping=true;
+	}
+	job_cv.notify_all();
+	room_cv.notify_all();
+	for (auto& t : builders) t.join();
+	builders.clear();
+	{
+		std::lock_guard<std::mutex> lock(ready_lock);
+		finishing=true;
+	}
+	ready_cv.notify_all();
+	applier.join();
+}
+
+/**
+* Push : queue a committed transaction
+*
+*/
+bool zpds::search::IndexPipeline::Push(::zpds::store::TransactionT&& trans)
+{
+	std::unique_lock<std::mutex> lock(job_lock);
+	room_cv.wait(lock, [this] { return stopping || jobs.size() < capacity; });
+	if (stopping) return false;
+	++inflight;
+	jobs.emplace_back( std::move(trans) );
+	lock.unlock();
+	job_cv.notify_one();
+	return true;
+}
+
+/**
+* Skip : log id that will never be pushed
+*
+*/
+void zpds::search::IndexPipeline::Skip(uint64_t logid)
+{
+	::zpds::store::TransactionT trans;
+	trans.set_id(logid);
+	Push( std::move(trans) );
+}
+
+/**
+* SetWatermark : last log id already in the index
+*
+*/
+void zpds::search::IndexPipeline::SetWatermark(uint64_t logid)
+{
+	{
+		std::lock_guard<std::mutex> lock(ready_lock);
+		seeded=true;
+		next_id = logid + 1;
+		last_indexed.store(logid);
+		skipped.clear();
+		touched.clear();
+		while (!ready.empty() && ready.begin()->first <= logid) {
+			ready.erase( ready.begin() );
+			--inflight;
+		}
+	}
+	ready_cv.notify_all();
+	idle_cv.notify_all();
+}
+
+/**
+* CommitAfter : request an index commit once this log id is written
+*
+*/
+void zpds::search::IndexPipeline::CommitAfter(uint64_t logid)
+{
+	uint64_t c = commit_at.load();
+	while (c < logid && !commit_at.compare_exchange_weak(c, logid)) {}
+	// already written
+	RunCommit( last_indexed.load() );
+}
+
+/**
+* Flush : wait till log ids upto this are written
+*
+*/
+bool zpds::search::IndexPipeline::Flush(uint64_t logid, uint64_t max_wait_ms)
+{
+	std::unique_lock<std::mutex> lock(ready_lock);
+	return idle_cv.wait_for(lock, std::chrono::milliseconds(max_wait_ms), [this,logid] { return last_indexed.load() >= logid; });
+}
+
+/**
+* GetLastIndexed : log id of last transaction written
+*
+*/
+uint64_t zpds::search::IndexPipeline::GetLastIndexed() const
+{
+	return last_indexed.load();
+}
+
+/**
+* GetInflight , GetGaps : counters
+*
+*/
+uint64_t zpds::search::IndexPipeline::GetInflight() const
+{
+	return inflight.load();
+}
+
+uint64_t zpds::search::IndexPipeline::GetGaps() const
+{
+	return gaps.load();
+}
+
+/**
+* Build : builder thread loop
+*
+*/
+void zpds::search::IndexPipeline::Build()
+{
+	while (true) {
+		::zpds::store::TransactionT trans;
+		{
+			std::unique_lock<std::mutex> lock(job_lock);
+			job_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty()) break; // stopping and drained
+			trans.Swap( &jobs.front() );
+			jobs.pop_front();
+		}
+		room_cv.notify_one();
+
+		OpListT ops = MakeOps(&trans);
+		{
+			std::lock_guard<std::mutex> lock(ready_lock);
+			ready[ trans.id() ] = std::move(ops);
+		}
+		ready_cv.notify_one();
+	}
+}
+
+/**
+* Apply : writer thread loop , log id order from the watermark , a missing id is given up
+*   after XAP_INDEX_GAP_MS , if it comes later its docs changed since are left alone
+*
+*/
+void zpds::search::IndexPipeline::Apply()
+{
+	uint64_t gap_since = 0;
+	std::unique_lock<std::mutex> lock(ready_lock);
+	while (true) {
+		// a gap is timed from when it is first seen , wake then and wait only the rest
+		uint64_t wait_ms = XAP_INDEX_GAP_MS;
+		if (gap_since>0) {
+			uint64_t currtime = ZPDS_CURRTIME_MS;
+			wait_ms = (currtime < gap_since + XAP_INDEX_GAP_MS) ? gap_since + XAP_INDEX_GAP_MS - currtime : 0;
+		}
+		ready_cv.wait_for(lock, std::chrono::milliseconds(wait_ms), [this,&gap_since] {
+			return finishing || ( seeded && !ready.empty() && ( gap_since==0 || ready.begin()->first <= next_id ) );
+		});
+		if (ready.empty()) {
+			if (finishing) break;
+			gap_since = 0;
+			continue;
+		}
+		if (!seeded) {
+			if (!finishing) continue;
+			// stopped before start , write what is there in order
+			seeded=true;
+			next_id = ready.begin()->first;
+		}
+
+		uint64_t currtime = ZPDS_CURRTIME_MS;
+		auto it = ready.begin();
+		if ( it->first > next_id ) {
+			// gap , earlier transaction still being built or lost
+			if (!finishing) {
+				if (gap_since==0) gap_since = currtime;
+				if (currtime < gap_since + XAP_INDEX_GAP_MS) continue;
+			}
+			++gaps;
+			LOG(INFO) << "Index pipeline gave up on log ids " << next_id << " to " << it->first - 1;
+			for (uint64_t id = next_id ; id < it->first ; ++id) skipped[id] = currtime;
+			next_id = it->first;
+		}
+		gap_since = 0;
+
+		// ids given up on long back are not coming
+		while (!skipped.empty() && currtime > skipped.begin()->second + XAP_INDEX_SKIP_KEEP_MS)
+			skipped.erase( skipped.begin() );
+		if (skipped.empty()) touched.clear();
+
+		uint64_t logid = it->first;
+		OpListT ops = std::move(it->second);
+		ready.erase(it);
+
+		bool late = (logid < next_id);
+		if (late) {
+			auto st = skipped.find(logid);
+			if (st == skipped.end()) {
+				// already written or given up long back
+				LOG(INFO) << "Index pipeline dropped log id " << logid << " behind " << next_id;
+				ops.clear();
+			}
+			else {
+				skipped.erase(st);
+				LOG(INFO) << "Index pipeline late log id " << logid;
+				OpListT keep;
+				for (auto& op : ops) {
+					auto tt = touched.find(op.idterm);
+					if (tt == touched.end() || tt->second < logid) keep.emplace_back( std::move(op) );
+				}
+				ops.swap(keep);
+			}
+		}
+		if (!skipped.empty()) {
+			for (auto& op : ops) {
+				uint64_t& t = touched[op.idterm];
+				if (t < logid) t = logid;
+			}
+		}
+		lock.unlock();
+
+		for (auto& op : ops) {
+			try {
+				if (op.to_del) writer->Delete(op.lang, op.dtyp, op.idterm);
+				else writer->Update(op.lang, op.dtyp, op.idterm, std::move(op.doc));
+			}
+			catch (Xapian::Error& e) {
+				LOG(ERROR) << "Index failed (xap) : " << op.idterm << " " << e.get_msg() << " " << e.get_description();
+			}
+			catch (std::exception& e) {
+				LOG(ERROR) << "Index failed : " << op.idterm << " " << e.what();
+			}
+		}
+
+		lock.lock();
+		if (!late) {
+			next_id = logid + 1;
+			last_indexed.store(logid);
+		}
+		--inflight;
+		lock.unlock();
+		if (!late) RunCommit(logid);
+		if (sched) sched->Notify();
+		idle_cv.notify_all();
+		lock.lock();
+	}
+}
+
+/**
+* RunCommit : commit if requested upto logid , once
+*
+*/
+void zpds::search::IndexPipeline::RunCommit(uint64_t logid)
+{
+	uint64_t c = commit_at.load();
+	if (c==0 || logid < c) return;
+	if (!commit_at.compare_exchange_strong(c, 0)) return;
+	if (sched) sched->RequestCommit();
+	else writer->CommitData();
+}
+
+/**
+* MakeOps : create index changes for a transaction
+*
+*/
+zpds::search::IndexPipeline::OpListT zpds::search::IndexPipeline::MakeOps(::zpds::store::TransactionT* trans) const
+{
+	OpListT ops;
+	for (auto i=0; i<trans->item_size(); ++i) {
+		auto item = trans->mutable_item(i);
+		std::string key = item->key();
+		if (!pipe_indexlocal.CheckPrimaryKey(key)) continue;
+		auto kp = pipe_indexlocal.DecodePrimaryKey( key );
+
+		const IndexBase* index = nullptr;
+		if (kp.first == ::zpds::store::K_LOCALDATA) index = &pipe_indexlocal;
+		else if (kp.first == ::zpds::store::K_WIKIDATA) index = &pipe_indexwiki;
+		else continue;
+
+		::zpds::store::ItemDataT record;
+		if (!record.ParseFromString(item->value())) continue;
+		try {
+			OpT op { record.lang(), index->GetIndexType(), "Q" + std::to_string(record.id()), item->to_del(), Xapian::Document() };
+			if (!op.to_del) op.doc = index->CreateDoc(&record);
+			ops.emplace_back( std::move(op) );
+		}
+		catch (Xapian::Error& e) {
+			LOG(ERROR) << "Index doc failed (xap) : " << record.id() << " " << e.get_msg();
+		}
+		catch (std::exception& e) {
+			LOG(ERROR) << "Index doc failed : " << record.id() << " " << e.what();
+		}
+	}
+	return ops;
+}
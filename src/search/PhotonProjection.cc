@@ -0,0 +1,100 @@
+/**
+ * @project zapdos
+ * @file src/search/PhotonProjection.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PhotonProjection.cc : Photon projection stored as document data
+ *
+ */
+#include "search/PhotonProjection.hpp"
+#include "utils/PrintWith.hpp"
+#include "utils/SplitWith.hpp"
+
+/**
+* Make : fill the photon feature served for a record
+*
+*/
+void zpds::search::PhotonProjection::Make(const ::zpds::store::ItemDataT* record, PhotonDataT* feat)
+{
+	feat->set_type( "Feature" );
+
+	auto prop = feat->mutable_properties();
+	prop->set_osm_id( record->osm_id() );
+	prop->set_osm_key( record->osm_key() );
+	prop->set_osm_value( record->osm_value() );
+	prop->set_osm_type( record->osm_type() );
+	prop->set_city( record->city() );
+	prop->set_country( record->country() );
+	prop->set_state( record->state() );
+	prop->set_name( ::zpds::utils::PrintWithComma::String( record->fld_name(), record->fld_area() ) );
+	prop->set_address( record->address() );
+	prop->set_postcode( record->pincode() );
+	prop->set_area( record->fld_area() );
+
+	// extents , parsed at write time , records written before that have only the geometry
+	if ( record->extent_size()==4 ) {
+		prop->mutable_extent()->CopyFrom( record->extent() );
+	}
+	else if ( ! record->geometry().empty() ) {
+		std::vector<double> extent;
+		if ( ::zpds::utils::SplitWith::Box( record->geometry(), extent ) )
+			for (auto& d : extent) prop->add_extent(d);
+	}
+
+	auto geom = feat->mutable_geometry();
+	geom->set_type( "Point" );
+	geom->add_coordinates( record->lon() );
+	geom->add_coordinates( record->lat() );
+}
+
+/**
+* Serialize : projection of a record to keep as document data
+*
+*/
+std::string zpds::search::PhotonProjection::Serialize(const ::zpds::store::ItemDataT* record)
+{
+	PhotonDataT feat;
+	Make( record, &feat );
+	std::string data( 1, XAP_PHOTON_DATA_MARK );
+	feat.AppendToString( &data );
+	return data;
+}
+
+/**
+* Load : read the projection of a record from the index
+*
+*/
+bool zpds::search::PhotonProjection::Load(const Xapian::Database& db, uint64_t id, PhotonDataT* feat)
+{
+	std::string idterm = "Q" + std::to_string(id);
+	Xapian::PostingIterator it = db.postlist_begin(idterm);
+	if ( it == db.postlist_end(idterm) ) return false;
+
+	std::string data = db.get_document( *it ).get_data();
+	if ( data.empty() || data[0] != XAP_PHOTON_DATA_MARK ) return false;
+	return feat->ParseFromArray( data.data() + 1, data.size() - 1 );
+}
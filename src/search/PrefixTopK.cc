@@ -0,0 +1,367 @@
+/**
+ * @project zapdos
+ * @file src/search/PrefixTopK.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  PrefixTopK.cc : Top documents by importance for short partial word prefixes impl
+ *
+ */
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+#include <boost/lexical_cast.hpp>
+
+#include "search/PrefixTopK.hpp"
+#include "search/GeoHashHelper.hpp"
+
+static const ::zpds::search::GeoHashHelper gh;
+
+// partial word terms a one word partial query needs together , the first is walked
+static const std::vector< std::vector<std::string> > prefix_combos {
+	{ XAP_PARTWORD_PREFIX },
+	{ XAP_BEGINPART_PREFIX, XAP_PARTWORD_PREFIX },
+	{ XAP_NAMEPART_PREFIX }
+};
+
+/**
+* EntryBefore : by key descending then docid , as xapian sorts on reverse value
+*
+*/
+static inline bool EntryBefore(const zpds::search::PrefixTopK::EntryT& a, const zpds::search::PrefixTopK::EntryT& b)
+{
+	return (a.key > b.key) || ( a.key == b.key && a.did < b.did );
+}
+
+/**
+* Join : node key from its terms
+*
+*/
+static std::string Join(const zpds::search::PrefixTopK::WordVecT& terms)
+{
+	std::string key;
+	for (auto& term : terms) {
+		if (!key.empty()) key += XAP_PREFIX_SEP;
+		key += term;
+	}
+	return key;
+}
+
+/**
+* Constructor : from nodes
+*
+*/
+zpds::search::PrefixTopK::PrefixTopK(uint64_t generation_, const ParamsT& params_, NodeMapT&& nodes_)
+	: generation(generation_), params(params_), nodes(std::move(nodes_))
+{}
+
+/**
+* destructor
+*/
+zpds::search::PrefixTopK::~PrefixTopK () {}
+
+/**
+* Build : build all nodes by walking postings of short partial terms
+*
+*/
+zpds::search::PrefixTopK::pointer zpds::search::PrefixTopK::Build(Xapian::Database& db, uint64_t generation, const ParamsT& params)
+{
+	NodeMapT nodes;
+	size_t depth = std::min<size_t>( params.depth, XAP_PREFIX_MAX_DEPTH );
+	for (auto& combo : prefix_combos) {
+		const std::string& family = combo.front();
+		for (auto t = db.allterms_begin(family) ; t != db.allterms_end(family) ; ) {
+			std::string walk = *t;
+			std::string p = walk.substr( family.length() );
+			// longer terms under a prefix already seen are skipped together
+			if ( p.length() > depth ) {
+				t.skip_to( family + p.substr(0,depth) + "\xff" );
+				continue;
+			}
+			WordVecT terms;
+			for (auto& f : combo) terms.emplace_back( f + p );
+			std::sort(terms.begin(), terms.end());
+			NodeT node = Scan(db, terms, params);
+			if ( !node.top.empty() ) nodes.emplace( Join(terms), std::move(node) );
+			++t;
+		}
+	}
+	return std::make_shared<const PrefixTopK>(generation, params, std::move(nodes));
+}
+
+/**
+* Update : copy of prev with changed documents taken out and put back
+*
+*/
+zpds::search::PrefixTopK::pointer zpds::search::PrefixTopK::Update(
+    const pointer& prev, Xapian::Database& db, uint64_t generation, const IdTermsT& idterms)
+{
+	const ParamsT& params = prev->params;
+	NodeMapT nodes(prev->nodes);
+	std::unordered_set<std::string> dirty;
+
+	// take out , a full list losing one may have had more below
+	std::unordered_set<uint64_t> changed;
+	for (auto& idterm : idterms) {
+		if ( idterm.length()>1 && idterm.at(0)=='Q' ) {
+			try {
+				changed.insert( boost::lexical_cast<uint64_t>( idterm.substr(1) ) );
+			}
+			catch (boost::bad_lexical_cast& e) {}
+		}
+	}
+	auto takeout = [&changed, &params](EntryVecT& list) -> bool {
+		bool full = ( list.size() >= params.items );
+		auto it = std::remove_if(list.begin(), list.end(), [&changed](const EntryT& e) {
+			return changed.find(e.id) != changed.end();
+		});
+		bool removed = ( it != list.end() );
+		list.erase(it, list.end());
+		return removed && full;
+	};
+	for (auto& node : nodes) {
+		bool walk = takeout(node.second.top);
+		for (auto& b : node.second.buckets) walk = takeout(b.second) || walk;
+		if (walk) dirty.insert(node.first);
+	}
+
+	// put back as now
+	for (auto& idterm : idterms) {
+		auto pit = db.postlist_begin(idterm);
+		if ( pit == db.postlist_end(idterm) ) continue;
+		Xapian::Document doc = db.get_document(*pit);
+		EntryT entry { doc.get_value(XAP_IMPORTANCE_POS), *pit, 0 };
+		try {
+			entry.id = boost::lexical_cast<uint64_t>( doc.get_value(XAP_ROCKSID_POS) );
+		}
+		catch (boost::bad_lexical_cast& e) {
+			continue;
+		}
+		std::string bucket = (params.geo) ? Bucket( doc.get_value(XAP_LATLON_POS) ) : std::string();
+
+		std::unordered_set<std::string> has;
+		for (auto t = doc.termlist_begin() ; t != doc.termlist_end() ; ++t) has.insert(*t);
+		for (auto& term : has) {
+			for (auto& terms : NodeTerms(term, params.depth) ) {
+				bool all = true;
+				for (auto& nt : terms) all = all && ( has.find(nt) != has.end() );
+				if (!all) continue;
+				std::string key = Join(terms);
+				if ( dirty.find(key) != dirty.end() ) continue;
+				auto& node = nodes[key];
+				Insert(node.top, entry, params.items);
+				if (!bucket.empty()) Insert(node.buckets[bucket], entry, params.items);
+			}
+		}
+	}
+
+	// walk again where needed
+	for (auto& key : dirty) {
+		WordVecT terms;
+		size_t pos = 0;
+		while (true) {
+			size_t next = key.find(XAP_PREFIX_SEP, pos);
+			terms.emplace_back( key.substr(pos, next - pos) );
+			if (next == std::string::npos) break;
+			pos = next + 1;
+		}
+		nodes[key] = Scan(db, terms, params);
+	}
+
+	for (auto it = nodes.begin() ; it != nodes.end() ; ) {
+		if ( it->second.top.empty() ) it = nodes.erase(it);
+		else ++it;
+	}
+	return std::make_shared<const PrefixTopK>(generation, params, std::move(nodes));
+}
+
+/**
+* Find : top items for query terms if this can answer them exactly
+*
+*/
+bool zpds::search::PrefixTopK::Find(const WordVecT& terms, size_t items, EntryVecT& out) const
+{
+	WordVecT nterms;
+	std::string bucket;
+	for (auto& term : terms) {
+		if ( term.compare(0, strlen(XAP_GEOHASH3_PREFIX), XAP_GEOHASH3_PREFIX) == 0 ) {
+			if ( !params.geo || !bucket.empty() ) return false;
+			bucket = term;
+		}
+		else {
+			nterms.emplace_back(term);
+		}
+	}
+	auto it = nodes.find( Join(nterms) );
+	if ( it == nodes.end() ) return false;
+
+	const EntryVecT* list = &(it->second.top);
+	static const EntryVecT empty;
+	if ( !bucket.empty() ) {
+		auto bit = it->second.buckets.find(bucket);
+		list = ( bit != it->second.buckets.end() ) ? &(bit->second) : &empty;
+	}
+
+	// a list shorter than kept has all that match
+	if ( items > params.items && list->size() >= params.items ) return false;
+	out.assign( list->begin(), list->begin() + std::min( items, list->size() ) );
+	return true;
+}
+
+/**
+* GetGeneration : commit generation
+*
+*/
+uint64_t zpds::search::PrefixTopK::GetGeneration() const
+{
+	return generation;
+}
+
+/**
+* GetNodes : no of nodes
+*
+*/
+size_t zpds::search::PrefixTopK::GetNodes() const
+{
+	return nodes.size();
+}
+
+/**
+* Scan : walk postings of the terms of a node
+*
+*/
+zpds::search::PrefixTopK::NodeT zpds::search::PrefixTopK::Scan(Xapian::Database& db, const WordVecT& terms, const ParamsT& params)
+{
+	NodeT node;
+	if ( terms.empty() ) return node;
+
+	// the rest and values are read on cursors moving with the walked postings
+	struct CursorT {
+		std::string term;
+		Xapian::PostingIterator it;
+	};
+	std::vector<CursorT> others;
+	for (size_t i=1 ; i<terms.size() ; ++i) others.push_back( { terms[i], db.postlist_begin(terms[i]) } );
+	Xapian::ValueIterator vimp = db.valuestream_begin(XAP_IMPORTANCE_POS);
+	Xapian::ValueIterator vloc = db.valuestream_begin(XAP_LATLON_POS);
+	Xapian::docid last = 0;
+
+	for (auto pit = db.postlist_begin(terms.front()) ; pit != db.postlist_end(terms.front()) ; ++pit) {
+		Xapian::docid did = *pit;
+		if ( did < last ) {
+			for (auto& c : others) c.it = db.postlist_begin(c.term);
+			vimp = db.valuestream_begin(XAP_IMPORTANCE_POS);
+			vloc = db.valuestream_begin(XAP_LATLON_POS);
+		}
+		last = did;
+
+		bool all = true;
+		for (auto& c : others) {
+			if ( c.it != db.postlist_end(c.term) && *c.it < did ) c.it.skip_to(did);
+			if ( c.it == db.postlist_end(c.term) || *c.it != did ) {
+				all = false;
+				break;
+			}
+		}
+		if (!all) continue;
+
+		EntryT entry { std::string(), did, 0 };
+		if ( vimp != db.valuestream_end(XAP_IMPORTANCE_POS) && vimp.get_docid() < did ) vimp.skip_to(did);
+		if ( vimp != db.valuestream_end(XAP_IMPORTANCE_POS) && vimp.get_docid() == did ) entry.key = *vimp;
+
+		std::string bucket;
+		if (params.geo) {
+			if ( vloc != db.valuestream_end(XAP_LATLON_POS) && vloc.get_docid() < did ) vloc.skip_to(did);
+			if ( vloc != db.valuestream_end(XAP_LATLON_POS) && vloc.get_docid() == did ) bucket = Bucket(*vloc);
+		}
+
+		bool keep = Insert(node.top, entry, params.items);
+		if (!bucket.empty()) keep = Insert(node.buckets[bucket], entry, params.items) || keep;
+		if (!keep) continue;
+
+		// id is read only for the few that get in
+		try {
+			uint64_t id = boost::lexical_cast<uint64_t>( db.get_document(did).get_value(XAP_ROCKSID_POS) );
+			for (auto& e : node.top) if (e.did == did) e.id = id;
+			if (!bucket.empty()) for (auto& e : node.buckets[bucket]) if (e.did == did) e.id = id;
+		}
+		catch (boost::bad_lexical_cast& e) {}
+	}
+	return node;
+}
+
+/**
+* Insert : keep entry if in top items
+*
+*/
+bool zpds::search::PrefixTopK::Insert(EntryVecT& list, const EntryT& entry, size_t items)
+{
+	if ( items == 0 ) return false;
+	if ( list.size() >= items && !EntryBefore(entry, list.back()) ) return false;
+	list.insert( std::upper_bound(list.begin(), list.end(), entry, EntryBefore), entry );
+	if ( list.size() > items ) list.pop_back();
+	return true;
+}
+
+/**
+* NodeTerms : terms of nodes a partial term is walked for
+*
+*/
+std::vector<zpds::search::PrefixTopK::WordVecT> zpds::search::PrefixTopK::NodeTerms(const std::string& walk, size_t depth)
+{
+	std::vector<WordVecT> out;
+	for (auto& combo : prefix_combos) {
+		const std::string& family = combo.front();
+		if ( walk.length() <= family.length() || walk.compare(0, family.length(), family) != 0 ) continue;
+		std::string p = walk.substr( family.length() );
+		if ( p.length() > std::min<size_t>( depth, XAP_PREFIX_MAX_DEPTH ) ) continue;
+		WordVecT terms;
+		for (auto& f : combo) terms.emplace_back( f + p );
+		std::sort(terms.begin(), terms.end());
+		out.emplace_back( std::move(terms) );
+	}
+	return out;
+}
+
+/**
+* Bucket : geohash3 cell as indexed for a location value
+*
+*/
+std::string zpds::search::PrefixTopK::Bucket(const std::string& value)
+{
+	if ( value.empty() ) return std::string();
+	Xapian::LatLongCoords coords;
+	coords.unserialise(value);
+	if ( coords.size()!=1 ) return std::string();
+	double lat = coords.begin()->latitude;
+	double lon = coords.begin()->longitude;
+	if ( lat==0.0 && lon==0.0 ) return std::string();
+	try {
+		return std::string(XAP_GEOHASH3_PREFIX) + gh.Encode( lat, lon, 9).substr(0,3);
+	}
+	catch (::zpds::BaseException& e) {}
+	return std::string();
+}
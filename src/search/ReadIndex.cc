@@ -50,10 +50,25 @@ zpds::search::ReadIndex::ReadIndex(std::string dbpath_)
 }
 
 /**
- * Destructor : default
+ * Constructor : with pool
  *
  */
-zpds::search::ReadIndex::~ReadIndex() {}
+zpds::search::ReadIndex::ReadIndex(ReaderPool::pointer pool_)
+	: dbpath( pool_ ? pool_->GetPath() : std::string() ), pool(pool_)
+{
+	if (!pool) throw zpds::InitialException("reader pool cannot be null");
+}
+
+/**
+ * Destructor : returns leased handles
+ *
+ */
+zpds::search::ReadIndex::~ReadIndex()
+{
+	for (auto& it : leasemap) {
+		pool->Release( ::zpds::search::LangTypeE(it.first / 1000), ::zpds::search::IndexTypeE(it.first % 1000), std::move(it.second) );
+	}
+}
 
 /**
 * Get: get the storage instance
@@ -61,15 +76,62 @@ zpds::search::ReadIndex::~ReadIndex() {}
 */
 zpds::search::ReadIndex::DatabaseT& zpds::search::ReadIndex::Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
 {
-	const google::protobuf::EnumDescriptor *l = zpds::search::LangTypeE_descriptor();
-	const google::protobuf::EnumDescriptor *d = zpds::search::IndexTypeE_descriptor();
 	int f = ltyp * 1000 + dtyp;
+	if (pool) {
+		auto it = leasemap.find(f);
+		if ( it == leasemap.end() )
+			it = leasemap.emplace(f, pool->Lease(ltyp, dtyp) ).first;
+		return *(it->second.db);
+	}
 	if ( triemap.find(f) == triemap.end() ) {
-		const std::string xapath{dbpath + "/" + l->FindValueByNumber(ltyp)->name() + "_" + d->FindValueByNumber(dtyp)->name()};
-		if (!boost::filesystem::exists(xapath))
-			throw ::zpds::BadCodeException("search dir does no exist for this language");
-		triemap[f] = DatabaseT(xapath, Xapian::DB_OPEN );
+		triemap[f] = ReaderPool::OpenUnion(dbpath, ltyp, dtyp);
 	}
 	return triemap.at(f);
 }
 
+/**
+* GetTools: enquire bound to the handle got by Get
+*
+*/
+zpds::search::ReaderPool::ToolsT& zpds::search::ReadIndex::GetTools(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	int f = ltyp * 1000 + dtyp;
+	auto& db = Get(ltyp, dtyp);
+	ReaderPool::ToolsT* tools = nullptr;
+	if (pool) {
+		tools = leasemap.at(f).tools.get();
+	}
+	else {
+		auto it = toolmap.find(f);
+		if ( it == toolmap.end() )
+			it = toolmap.emplace(f, std::make_shared<ReaderPool::ToolsT>(db) ).first;
+		tools = it->second.get();
+	}
+	// sorters of the last user are gone , weighting is always bool
+	tools->enquire.set_sort_by_relevance();
+	return *tools;
+}
+
+/**
+* GetGeoColumn: decoded location columns for the handle got by Get
+*
+*/
+zpds::search::GeoColumn::pointer zpds::search::ReadIndex::GetGeoColumn(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	if (!pool) return nullptr;
+	auto it = leasemap.find( ltyp * 1000 + dtyp );
+	if ( it == leasemap.end() ) return nullptr;
+	return pool->GetGeoColumn(ltyp, dtyp, it->second);
+}
+
+/**
+* GetPrefixTopK: top documents of short prefixes for the handle got by Get
+*
+*/
+zpds::search::PrefixTopK::pointer zpds::search::ReadIndex::GetPrefixTopK(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	if (!pool) return nullptr;
+	auto it = leasemap.find( ltyp * 1000 + dtyp );
+	if ( it == leasemap.end() ) return nullptr;
+	return pool->GetPrefixTopK(ltyp, dtyp, it->second);
+}
@@ -0,0 +1,450 @@
+/**
+ * @project zapdos
+ * @file src/search/ReaderPool.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ReaderPool.cc : Shared pool of Xapian read handles impl
+ *
+ */
+#include "search/ReaderPool.hpp"
+#include <boost/filesystem.hpp>
+
+
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::ReaderPool::ReaderPool(std::string dbpath_, WriteIndex::pointer writer_, size_t max_idle_, bool geo_column_,
+                                     PrefixTopK::ParamsT prefix_)
+	: dbpath(dbpath_), writer(writer_), max_idle(max_idle_), geo_column(geo_column_), hits(0), misses(0), reopens(0),
+	  seen_generation(0), last_lag(0), max_lag(0), column_builds(0), column_updates(0),
+	  prefix_params(prefix_), prefix_builds(0), prefix_updates(0), refresh_stop(false)
+{
+	if (dbpath.empty()) throw zpds::InitialException("dbpath cannot be blank");
+	if (geo_column || prefix_params.depth>0) refresher = std::thread(&ReaderPool::RefreshLoop, this);
+}
+
+/**
+ * ToolsT Constructor : enquire on the handle , reopen is seen by it
+ *
+ */
+zpds::search::ReaderPool::ToolsT::ToolsT(const DatabaseT& db)
+	: enquire(db)
+{
+	enquire.set_weighting_scheme(Xapian::BoolWeight());
+}
+
+/**
+ * Destructor : default
+ *
+ */
+zpds::search::ReaderPool::~ReaderPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(refresh_lock);
+		refresh_stop=true;
+	}
+	refresh_cv.notify_all();
+	if (refresher.joinable()) refresher.join();
+	std::lock_guard<std::mutex> lock(pool_lock);
+	for (auto& it : freemap) {
+		for (auto& h : it.second) h.db->close();
+	}
+}
+
+/**
+* Lease: get an exclusive handle
+*
+*/
+zpds::search::ReaderPool::HandleT zpds::search::ReaderPool::Lease(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	int f = ltyp * 1000 + dtyp;
+	// read snapshot before open or reopen so a handle is never marked newer than its content
+	auto snap = Snapshot();
+	uint64_t gen = (snap) ? snap->generation : 0;
+	HandleT handle{nullptr,0,nullptr};
+	{
+		std::lock_guard<std::mutex> lock(pool_lock);
+		auto it = freemap.find(f);
+		if ( it != freemap.end() && !it->second.empty() ) {
+			handle = std::move(it->second.back());
+			it->second.pop_back();
+		}
+	}
+
+	if (!handle.db) {
+		++misses;
+		handle.db = Open(ltyp, dtyp);
+		handle.generation = gen;
+		handle.tools = std::make_shared<ToolsT>( *handle.db );
+		UpdateLag(snap);
+		RequestRefresh(ltyp, dtyp);
+		return handle;
+	}
+
+	++hits;
+	if (handle.generation != gen) {
+		handle.db->reopen();
+		handle.generation = gen;
+		++reopens;
+		UpdateLag(snap);
+		RequestRefresh(ltyp, dtyp);
+	}
+	return handle;
+}
+
+/**
+* Release: return a leased handle to the pool
+*
+*/
+void zpds::search::ReaderPool::Release(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, HandleT&& handle)
+{
+	if (!handle.db) return;
+	int f = ltyp * 1000 + dtyp;
+	std::lock_guard<std::mutex> lock(pool_lock);
+	auto& flist = freemap[f];
+	if (flist.size() < max_idle) flist.emplace_back(std::move(handle));
+}
+
+/**
+* GetGeoColumn: decoded location columns matching a leased handle
+*
+*/
+zpds::search::GeoColumn::pointer zpds::search::ReaderPool::GetGeoColumn(
+    ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const HandleT& handle)
+{
+	if (!geo_column) return nullptr;
+	int f = ltyp * 1000 + dtyp;
+	{
+		std::lock_guard<std::mutex> lock(column_lock);
+		auto it = columns.find(f);
+		if ( it != columns.end() && it->second->GetGeneration() == handle.generation ) return it->second;
+	}
+	// not yet built for this generation , caller uses the value slots meanwhile
+	RequestRefresh(ltyp, dtyp);
+	return nullptr;
+}
+
+/**
+* RequestRefresh: queue a refresh of columns for an index , does not wait
+*
+*/
+void zpds::search::ReaderPool::RequestRefresh(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	if (!refresher.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(refresh_lock);
+		if ( !pending.insert( ltyp * 1000 + dtyp ).second ) return;
+	}
+	refresh_cv.notify_one();
+}
+
+/**
+* RefreshLoop: refresher thread loop , opens its own handles at the latest generation
+*
+*/
+void zpds::search::ReaderPool::RefreshLoop()
+{
+	std::unordered_map<int, DbPtrT> dbs;
+	std::unique_lock<std::mutex> lock(refresh_lock);
+	while (true) {
+		refresh_cv.wait(lock, [this] { return refresh_stop || !pending.empty(); });
+		if (refresh_stop) break;
+		int f = *pending.begin();
+		pending.erase( pending.begin() );
+		lock.unlock();
+
+		auto ltyp = static_cast<::zpds::search::LangTypeE>(f / 1000);
+		auto dtyp = static_cast<::zpds::search::IndexTypeE>(f % 1000);
+		// snapshot before open or reopen as in Lease
+		auto snap = Snapshot();
+		uint64_t gen = (snap) ? snap->generation : 0;
+		try {
+			auto& db = dbs[f];
+			if (!db) db = Open(ltyp, dtyp);
+			else db->reopen();
+			auto after = Snapshot();
+			if ( after && after->generation != gen ) {
+				// committed while opening , content may be newer than gen , go again
+				lock.lock();
+				pending.insert(f);
+				continue;
+			}
+			RefreshColumn(ltyp, dtyp, *db, gen);
+			RefreshPrefix(ltyp, dtyp, *db, gen);
+		}
+		catch (Xapian::Error& e) {
+			LOG(INFO) << "Index refresh failed: " << e.get_msg();
+			dbs.erase(f);
+		}
+		catch (std::exception& e) {
+			LOG(INFO) << "Index refresh failed: " << e.what();
+			dbs.erase(f);
+		}
+		lock.lock();
+	}
+	for (auto& it : dbs) if (it.second) it.second->close();
+}
+
+/**
+* RefreshColumn: bring the location columns upto a generation , refresher thread only
+*
+*/
+void zpds::search::ReaderPool::RefreshColumn(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
+        DatabaseT& db, uint64_t generation)
+{
+	if (!geo_column) return;
+	int f = ltyp * 1000 + dtyp;
+	GeoColumn::pointer prev;
+	{
+		std::lock_guard<std::mutex> lock(column_lock);
+		auto it = columns.find(f);
+		if ( it != columns.end() ) {
+			prev = it->second;
+			if ( prev->GetGeneration() >= generation ) return;
+		}
+	}
+
+	// built outside the lock , searches keep the older one or the value slots till it is swapped in
+	GeoColumn::pointer next;
+	try {
+		GeoColumn::IdTermsT idterms;
+		if ( prev && writer && writer->GetChanges(ltyp, dtyp, prev->GetGeneration(), generation, idterms) ) {
+			next = GeoColumn::Update(prev, db, generation, idterms);
+			++column_updates;
+		}
+		else {
+			next = GeoColumn::Build(db, generation);
+			++column_builds;
+		}
+	}
+	catch (Xapian::Error& e) {
+		LOG(INFO) << "Location column not built: " << e.get_msg();
+	}
+
+	std::lock_guard<std::mutex> lock(column_lock);
+	if (next) columns[f] = next;
+}
+
+/**
+* GetColumnBuilds , GetColumnUpdates , GetColumnRows : location column counters
+*
+*/
+uint64_t zpds::search::ReaderPool::GetColumnBuilds() const
+{
+	return column_builds.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetColumnUpdates() const
+{
+	return column_updates.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetColumnRows()
+{
+	uint64_t rows = 0;
+	std::lock_guard<std::mutex> lock(column_lock);
+	for (auto& it : columns) rows += it.second->GetRows();
+	return rows;
+}
+
+/**
+* GetPrefixTopK: top documents of short prefixes matching a leased handle
+*
+*/
+zpds::search::PrefixTopK::pointer zpds::search::ReaderPool::GetPrefixTopK(
+    ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const HandleT& handle)
+{
+	if (prefix_params.depth==0) return nullptr;
+	int f = ltyp * 1000 + dtyp;
+	{
+		std::lock_guard<std::mutex> lock(prefix_lock);
+		auto it = prefixes.find(f);
+		if ( it != prefixes.end() && it->second->GetGeneration() == handle.generation ) return it->second;
+	}
+	// not yet built for this generation , caller uses the wildcard query meanwhile
+	RequestRefresh(ltyp, dtyp);
+	return nullptr;
+}
+
+/**
+* RefreshPrefix: bring the prefix top documents upto a generation , refresher thread only
+*
+*/
+void zpds::search::ReaderPool::RefreshPrefix(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
+        DatabaseT& db, uint64_t generation)
+{
+	if (prefix_params.depth==0) return;
+	int f = ltyp * 1000 + dtyp;
+	PrefixTopK::pointer prev;
+	{
+		std::lock_guard<std::mutex> lock(prefix_lock);
+		auto it = prefixes.find(f);
+		if ( it != prefixes.end() ) {
+			prev = it->second;
+			if ( prev->GetGeneration() >= generation ) return;
+		}
+	}
+
+	// built outside the lock , the new trie is swapped in whole when done
+	PrefixTopK::pointer next;
+	try {
+		PrefixTopK::IdTermsT idterms;
+		if ( prev && writer && writer->GetChanges(ltyp, dtyp, prev->GetGeneration(), generation, idterms) ) {
+			next = PrefixTopK::Update(prev, db, generation, idterms);
+			++prefix_updates;
+		}
+		else {
+			next = PrefixTopK::Build(db, generation, prefix_params);
+			++prefix_builds;
+		}
+	}
+	catch (Xapian::Error& e) {
+		LOG(INFO) << "Prefix top documents not built: " << e.get_msg();
+	}
+
+	std::lock_guard<std::mutex> lock(prefix_lock);
+	if (next) prefixes[f] = next;
+}
+
+/**
+* GetPrefixBuilds , GetPrefixUpdates , GetPrefixNodes : prefix top documents counters
+*
+*/
+uint64_t zpds::search::ReaderPool::GetPrefixBuilds() const
+{
+	return prefix_builds.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetPrefixUpdates() const
+{
+	return prefix_updates.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetPrefixNodes()
+{
+	uint64_t nodes = 0;
+	std::lock_guard<std::mutex> lock(prefix_lock);
+	for (auto& it : prefixes) nodes += it.second->GetNodes();
+	return nodes;
+}
+
+/**
+* GetPath: get the base path
+*
+*/
+const std::string& zpds::search::ReaderPool::GetPath() const
+{
+	return dbpath;
+}
+
+/**
+* GetHits , GetMisses , GetReopens : counters
+*
+*/
+uint64_t zpds::search::ReaderPool::GetHits() const
+{
+	return hits.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetMisses() const
+{
+	return misses.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetReopens() const
+{
+	return reopens.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetLastLag() const
+{
+	return last_lag.load();
+}
+
+uint64_t zpds::search::ReaderPool::GetMaxLag() const
+{
+	return max_lag.load();
+}
+
+/**
+* Snapshot: current commit snapshot of writer
+*
+*/
+zpds::search::WriteIndex::SnapshotPtrT zpds::search::ReaderPool::Snapshot() const
+{
+	return (writer) ? writer->GetSnapshot() : WriteIndex::SnapshotPtrT();
+}
+
+/**
+* UpdateLag: record freshness lag once per generation
+*
+*/
+void zpds::search::ReaderPool::UpdateLag(const WriteIndex::SnapshotPtrT& snap)
+{
+	if (!snap) return;
+	uint64_t seen = seen_generation.load();
+	while ( seen < snap->generation ) {
+		if ( seen_generation.compare_exchange_weak(seen, snap->generation) ) {
+			uint64_t currtime = ZPDS_CURRTIME_MS;
+			uint64_t lag = (currtime > snap->committed_at) ? currtime - snap->committed_at : 0;
+			last_lag.store(lag);
+			uint64_t mlag = max_lag.load();
+			while ( lag > mlag && !max_lag.compare_exchange_weak(mlag, lag) ) {}
+			return;
+		}
+	}
+}
+
+/**
+* Open: open a new handle
+*
+*/
+zpds::search::ReaderPool::DbPtrT zpds::search::ReaderPool::Open(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	return std::make_shared<DatabaseT>( OpenUnion(dbpath, ltyp, dtyp) );
+}
+
+/**
+* OpenUnion: open all shards of an index as one database
+*
+*/
+zpds::search::ReaderPool::DatabaseT zpds::search::ReaderPool::OpenUnion(const std::string& dbpath,
+        ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+{
+	const std::string xapath = WriteIndex::ShardPath(dbpath, ltyp, dtyp, 0);
+	if (!boost::filesystem::exists(xapath))
+		throw ::zpds::BadCodeException("search dir does no exist for this language");
+	DatabaseT db(xapath, Xapian::DB_OPEN);
+	for (size_t k=1 ; k < XAP_MAX_SHARDS ; ++k) {
+		const std::string spath = WriteIndex::ShardPath(dbpath, ltyp, dtyp, k);
+		if (!boost::filesystem::exists(spath)) break;
+		db.add_database( DatabaseT(spath, Xapian::DB_OPEN) );
+	}
+	return db;
+}
@@ -0,0 +1,254 @@
+/**
+ * @project zapdos
+ * @file src/search/ResultCache.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ResultCache.cc : Sharded bounded cache of completion results impl
+ *
+ */
+#include <algorithm>
+#include <functional>
+
+#include "search/ResultCache.hpp"
+
+/**
+* Mix : spread bits of hash for sketch rows
+*
+*/
+static inline uint64_t Mix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/**
+* Constructor : default
+*
+*/
+zpds::search::ResultCache::ResultCache(uint64_t max_bytes_, uint64_t ttl_ms_, size_t shards_)
+	: ttl_ms( (ttl_ms_>0) ? ttl_ms_ : XAP_RESULT_CACHE_TTL_MS ),
+	  shard_bytes( max_bytes_ / ( (shards_>0) ? shards_ : XAP_RESULT_CACHE_SHARDS ) ),
+	  sketch_width(XAP_RESULT_SKETCH_MIN),
+	  hits(0),
+	  misses(0),
+	  rejects(0),
+	  evictions(0),
+	  bytes(0),
+	  entries(0)
+{
+	size_t expected = XAP_RESULT_SKETCH_RATIO * shard_bytes / XAP_RESULT_SKETCH_ENTRY;
+	while (sketch_width < expected) sketch_width <<= 1;
+	size_t nshards = (shards_>0) ? shards_ : XAP_RESULT_CACHE_SHARDS;
+	for (size_t i=0 ; i<nshards ; ++i) {
+		shards.emplace_back( new ShardT );
+		shards.back()->bytes = 0;
+		shards.back()->additions = 0;
+		shards.back()->sketch.assign( XAP_RESULT_SKETCH_ROWS * sketch_width, 0 );
+	}
+}
+
+/**
+* destructor
+*/
+zpds::search::ResultCache::~ResultCache () {}
+
+/**
+* Get: get ids if fresh
+*
+*/
+bool zpds::search::ResultCache::Get(const std::string& key, uint64_t generation, IdVecT& ids)
+{
+	size_t hash = std::hash<std::string>()(key);
+	auto& shard = *shards[ hash % shards.size() ];
+	std::lock_guard<std::mutex> lock(shard.lock);
+	Touch(shard, hash);
+	auto it = shard.index.find(key);
+	if (it == shard.index.end()) {
+		++misses;
+		return false;
+	}
+	if ( Stale( *(it->second), generation, ZPDS_CURRTIME_MS ) ) {
+		Remove(shard, it->second);
+		++misses;
+		return false;
+	}
+	shard.lru.splice( shard.lru.begin(), shard.lru, it->second );
+	ids = it->second->ids;
+	++hits;
+	return true;
+}
+
+/**
+* Put: add ids if admitted
+*
+*/
+bool zpds::search::ResultCache::Put(const std::string& key, uint64_t generation, const IdVecT& ids)
+{
+	size_t need = 2*key.size() + ids.size() * sizeof(uint64_t) + XAP_RESULT_CACHE_OVERHEAD;
+	if (need > shard_bytes) return false;
+
+	size_t hash = std::hash<std::string>()(key);
+	auto& shard = *shards[ hash % shards.size() ];
+	std::lock_guard<std::mutex> lock(shard.lock);
+	uint64_t now = ZPDS_CURRTIME_MS;
+
+	auto it = shard.index.find(key);
+	if (it != shard.index.end()) Remove(shard, it->second);
+
+	// make space , a stale or rarer victim goes , else the new one is not let in
+	uint8_t freq = Frequency(shard, hash);
+	while ( shard.bytes + need > shard_bytes && !shard.lru.empty() ) {
+		auto victim = std::prev( shard.lru.end() );
+		if ( !Stale(*victim, generation, now) ) {
+			if ( freq <= Frequency(shard, std::hash<std::string>()(victim->key) ) ) {
+				++rejects;
+				return false;
+			}
+			++evictions;
+		}
+		Remove(shard, victim);
+	}
+
+	shard.lru.push_front( { key, generation, now + ttl_ms, ids, need } );
+	shard.index.emplace( key, shard.lru.begin() );
+	shard.bytes += need;
+	bytes += need;
+	++entries;
+	return true;
+}
+
+/**
+* Touch : count an access in sketch , halved every so often to age
+*
+*/
+void zpds::search::ResultCache::Touch(ShardT& shard, size_t hash)
+{
+	uint64_t h1 = hash;
+	uint64_t h2 = Mix(hash) | 1;
+	for (size_t r=0 ; r<XAP_RESULT_SKETCH_ROWS ; ++r) {
+		auto& c = shard.sketch[ r * sketch_width + ( (h1 + r*h2) & (sketch_width-1) ) ];
+		if (c < XAP_RESULT_SKETCH_MAX_COUNT) ++c;
+	}
+	if ( ++shard.additions >= 10 * sketch_width ) {
+		for (auto& c : shard.sketch) c >>= 1;
+		shard.additions = 0;
+	}
+}
+
+/**
+* Frequency : estimated recent accesses
+*
+*/
+uint8_t zpds::search::ResultCache::Frequency(ShardT& shard, size_t hash) const
+{
+	uint64_t h1 = hash;
+	uint64_t h2 = Mix(hash) | 1;
+	uint8_t freq = XAP_RESULT_SKETCH_MAX_COUNT;
+	for (size_t r=0 ; r<XAP_RESULT_SKETCH_ROWS ; ++r)
+		freq = std::min( freq, shard.sketch[ r * sketch_width + ( (h1 + r*h2) & (sketch_width-1) ) ] );
+	return freq;
+}
+
+/**
+* Remove : remove an entry
+*
+*/
+void zpds::search::ResultCache::Remove(ShardT& shard, ListT::iterator it)
+{
+	shard.bytes -= it->bytes;
+	bytes -= it->bytes;
+	--entries;
+	shard.index.erase(it->key);
+	shard.lru.erase(it);
+}
+
+/**
+* Stale : check if entry is stale
+*
+*/
+bool zpds::search::ResultCache::Stale(const EntryT& entry, uint64_t generation, uint64_t now) const
+{
+	return ( entry.generation != generation ) || ( entry.expires <= now );
+}
+
+/**
+* GetHits : lookups found
+*
+*/
+uint64_t zpds::search::ResultCache::GetHits() const
+{
+	return hits.load();
+}
+
+/**
+* GetMisses : lookups not found or stale
+*
+*/
+uint64_t zpds::search::ResultCache::GetMisses() const
+{
+	return misses.load();
+}
+
+/**
+* GetRejects : new entries not admitted
+*
+*/
+uint64_t zpds::search::ResultCache::GetRejects() const
+{
+	return rejects.load();
+}
+
+/**
+* GetEvictions : entries removed for space
+*
+*/
+uint64_t zpds::search::ResultCache::GetEvictions() const
+{
+	return evictions.load();
+}
+
+/**
+* GetBytes : approx bytes used
+*
+*/
+uint64_t zpds::search::ResultCache::GetBytes() const
+{
+	return bytes.load();
+}
+
+/**
+* GetEntries : entries held
+*
+*/
+uint64_t zpds::search::ResultCache::GetEntries() const
+{
+	return entries.load();
+}
@@ -0,0 +1,153 @@
+/**
+ * @project zapdos
+ * @file src/search/RuleTagger.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  RuleTagger.cc : Tags matches of a fused query to the profile rules they satisfy impl
+ *
+ */
+#include <algorithm>
+
+#include "search/RuleTagger.hpp"
+
+/**
+* ScoreBefore : by key descending then docid , as xapian sorts on reverse value
+*
+*/
+static inline bool ScoreBefore(const zpds::search::RuleTagger::ScoreT& a, const zpds::search::RuleTagger::ScoreT& b)
+{
+	return (a.key > b.key) || ( a.key == b.key && a.did < b.did );
+}
+
+/**
+* Constructor: default
+*
+*/
+zpds::search::RuleTagger::RuleTagger(const Xapian::Database& db_, Xapian::valueno slot_)
+	: db(db_),
+	  slot(slot_)
+{}
+
+/**
+* Destructor: default
+*
+*/
+zpds::search::RuleTagger::~RuleTagger() {}
+
+/**
+* AddRule: add a rule by terms it needs beyond the query
+*
+*/
+size_t zpds::search::RuleTagger::AddRule(const TermVecT& terms, size_t items)
+{
+	RuleT rule;
+	rule.items = items;
+	for (auto& term : terms) {
+		auto it = cursormap.find(term);
+		if (it == cursormap.end()) {
+			it = cursormap.emplace( term, cursors.size() ).first;
+			cursors.push_back( { term, db.postlist_begin(term), 0 } );
+		}
+		rule.cursors.push_back( it->second );
+	}
+	rules.push_back( std::move(rule) );
+	return rules.size()-1;
+}
+
+/**
+* operator(): tag , always rejects
+*
+*/
+bool zpds::search::RuleTagger::operator()(const Xapian::Document& doc) const
+{
+	Xapian::docid did = doc.get_docid();
+	std::string key;
+	bool haskey = false;
+	for (auto& rule : rules) {
+		bool found = true;
+		for (auto c : rule.cursors) {
+			if ( !Has(c, did) ) {
+				found = false;
+				break;
+			}
+		}
+		if (!found) continue;
+		if (!haskey) {
+			key = doc.get_value(slot);
+			haskey = true;
+		}
+		Push(rule, key, did);
+	}
+	return false;
+}
+
+/**
+* Finish: get top items of a rule
+*
+*/
+zpds::search::RuleTagger::ScoreVecT zpds::search::RuleTagger::Finish(size_t rule) const
+{
+	ScoreVecT out;
+	if (rule >= rules.size()) return out;
+	out = rules[rule].heap;
+	std::sort(out.begin(), out.end(), ScoreBefore);
+	return out;
+}
+
+/**
+* Has: check if the term of a cursor is in document
+*
+*/
+bool zpds::search::RuleTagger::Has(size_t cursor, Xapian::docid did) const
+{
+	auto& c = cursors[cursor];
+	// matcher goes back only on moving to the next sub database
+	if (did < c.last) c.it = db.postlist_begin(c.term);
+	c.last = did;
+	if (c.it == db.postlist_end(c.term)) return false;
+	if (*c.it < did) c.it.skip_to(did);
+	return (c.it != db.postlist_end(c.term) && *c.it == did);
+}
+
+/**
+* Push: keep if in top items , heap has the worst on top
+*
+*/
+void zpds::search::RuleTagger::Push(RuleT& rule, const std::string& key, Xapian::docid did) const
+{
+	if (rule.items==0) return;
+	ScoreT score{key, did};
+	if (rule.heap.size() < rule.items) {
+		rule.heap.push_back(score);
+		std::push_heap(rule.heap.begin(), rule.heap.end(), ScoreBefore);
+		return;
+	}
+	if ( !ScoreBefore(score, rule.heap.front()) ) return;
+	std::pop_heap(rule.heap.begin(), rule.heap.end(), ScoreBefore);
+	rule.heap.back() = score;
+	std::push_heap(rule.heap.begin(), rule.heap.end(), ScoreBefore);
+}
@@ -32,17 +32,37 @@
  */
 #include "search/SearchBase.hpp"
 #include <boost/lexical_cast.hpp>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
 #include "search/DistanceSlabKeyMaker.hpp"
+#include "search/DistanceSlabBatch.hpp"
+#include "search/RuleTagger.hpp"
 #include "store/ExterCredService.hpp"
 
 #include "utils/SplitWith.hpp"
 #include "utils/PrintWith.hpp"
 #include "utils/SortHelpers.hpp"
 #include "search/GeoHashHelper.hpp"
+#include "async++.h"
 
 const ::zpds::search::GeoHashHelper gh;
 const ::zpds::store::ExterCredService ucserv;
 
+namespace {
+/**
+* RuleWorker : searcher with its own read handles , runs one rule on a pool thread
+*
+*/
+class RuleWorker : virtual public ::zpds::search::SearchBase {
+public:
+	RuleWorker(::zpds::search::ReaderPool::pointer pool_) : ::zpds::search::ReadIndex(pool_) {}
+	void CompletionQueryAction(::zpds::utils::SharedTable::pointer stptr, ::zpds::query::SearchCompletionRespT* resp) override {}
+	using ::zpds::search::SearchBase::RuleSearch;
+};
+} // namespace
+
 /**
 * SanitParams : sanitize user params
 *
@@ -97,140 +117,237 @@ size_t zpds::search::SearchBase::SetQuery(const std::string& query_)
 }
 
 /**
-* GetQueryString: set query
+* PartQuery: partial word term , expanded over full words if beyond the indexed length
 *
 */
-std::string zpds::search::SearchBase::GetQueryString(
-    QueryWordsE qtype, const std::string& extra,
-    const std::string& full_prefix, const std::string& part_prefix)
+Xapian::Query zpds::search::SearchBase::PartQuery(
+    const std::string& word, const std::string& full_prefix, const std::string& part_prefix)
 {
+	if ( OverPartLimit( word ) )
+		return Xapian::Query( Xapian::Query::OP_WILDCARD, full_prefix + word );
+	return Xapian::Query( part_prefix + word );
+}
 
-	std::ostringstream xtmp;
-	for (int i=0; i<wordstr.size(); ++i) {
-		if ( ( qtype == ALL_PARTIAL ) || ( qtype == LAST_PARTIAL && i==(wordstr.size()-1) ) ) {
-			xtmp << ' ' << part_prefix << wordstr.at(i);
-		}
-		else {
-			xtmp << ' ' << full_prefix << wordstr.at(i);
-		}
+/**
+* GetQuery: query from wordstr , rule terms and filters
+*
+*/
+Xapian::Query zpds::search::SearchBase::GetQuery(const ::zpds::search::UsedParamsT* qr)
+{
+	QueryWordsE qtype = ( qr->all_partial() ) ? ALL_PARTIAL : ( qr->last_partial() ) ? LAST_PARTIAL : FULL_WORDS;
+
+	std::string full_prefix;
+	std::string part_prefix { XAP_PARTWORD_PREFIX };
+	if ( qr->use_name() ) {
+		full_prefix = std::string(XAP_NAMEFULL_PREFIX);
+		part_prefix = std::string(XAP_NAMEPART_PREFIX);
 	}
 
-	if (! extra.empty() ) xtmp << ' ' << extra;
-	return xtmp.str();
-}
+	std::vector<Xapian::Query> musts;
+	for (size_t i=0; i<wordstr.size(); ++i) {
+		if ( ( qtype == ALL_PARTIAL ) || ( qtype == LAST_PARTIAL && i==(wordstr.size()-1) ) )
+			musts.emplace_back( PartQuery( wordstr.at(i), full_prefix, part_prefix ) );
+		else
+			musts.emplace_back( full_prefix + wordstr.at(i) );
+	}
 
+	// limit and begin with terms from the rule
+	for (auto i=0; i < qr->limit_terms_size() ; ++i)
+		musts.emplace_back( qr->limit_terms(i) );
+	if ( !qr->begin_word().empty() ) {
+		if ( qr->begin_part() )
+			musts.emplace_back( PartQuery( qr->begin_word(), XAP_BEGINFULL_PREFIX, XAP_BEGINPART_PREFIX ) );
+		else
+			musts.emplace_back( XAP_BEGINFULL_PREFIX + qr->begin_word() );
+	}
+
+	std::vector<Xapian::Query> filters;
+	for (auto i=0; i < qr->filter_categories_size() ; ++i)
+		filters.emplace_back( XAP_CATEGORY_PREFIX + qr->filter_categories(i) );
+
+	for (auto i=0; i < qr->filter_tags_size() ; ++i)
+		filters.emplace_back( XAP_TAG_PREFIX + FormatTag(qr->filter_tags(i).name(), qr->filter_tags(i).value() ) );
+
+	Xapian::Query query( Xapian::Query::OP_AND, musts.begin(), musts.end() );
+	if ( filters.empty() ) return query;
+	Xapian::Query filter( Xapian::Query::OP_AND, filters.begin(), filters.end() );
+	return ( musts.empty() ) ? filter : Xapian::Query( Xapian::Query::OP_FILTER, query, filter );
+}
 
 /**
-* FindNear: check if exists nearby
+* PartsOverLimit: check if any partial word is beyond the indexed length
 *
 */
-bool zpds::search::SearchBase::FindNear(::zpds::search::UsedParamsT* qr, bool reset)
+bool zpds::search::SearchBase::PartsOverLimit(const ::zpds::search::UsedParamsT* qr)
 {
+	// begin with part
+	if ( qr->begin_part() && OverPartLimit( qr->begin_word() ) ) return true;
 
-	auto db = Get(qr->lang(), qr->dtyp() );
-	auto wordstr_size = wordstr.size();
-	if (qr->location().dont_use()) return false;
-	if (reset) wordstr_size = SetQuery(qr->query());
-
-	if ( (! qr->noname() ) && ( wordstr_size==0) ) return false;
+	if ( wordstr.empty() || ! ( qr->all_partial() || qr->last_partial() ) ) return false;
+	if (! qr->all_partial() ) return OverPartLimit( wordstr.back() );
+	for (auto& word : wordstr )
+		if ( OverPartLimit( word ) ) return true;
+	return false;
+}
 
+/**
+* GetQueryTerms: terms all needed for the query
+*
+*/
+zpds::search::SearchBase::WordVecT zpds::search::SearchBase::GetQueryTerms(const ::zpds::search::UsedParamsT* qr)
+{
 	QueryWordsE qtype = ( qr->all_partial() ) ? ALL_PARTIAL : ( qr->last_partial() ) ? LAST_PARTIAL : FULL_WORDS;
 
-	std::string full_prefix { XAP_FORMAT_PLUS };
-	std::string part_prefix { XAP_FORMAT_PLUS XAP_PARTWORD_PREFIX };
+	std::string full_prefix;
+	std::string part_prefix { XAP_PARTWORD_PREFIX };
 	if ( qr->use_name() ) {
-		full_prefix = std::string(XAP_FORMAT_PLUS XAP_NAMEFULL_PREFIX);
-		part_prefix = std::string(XAP_FORMAT_PLUS XAP_NAMEPART_PREFIX);
+		full_prefix = std::string(XAP_NAMEFULL_PREFIX);
+		part_prefix = std::string(XAP_NAMEPART_PREFIX);
 	}
 
-	std::ostringstream xtmp;
-	xtmp << GetQueryString( qtype, qr->extra(), full_prefix, part_prefix);
-
-	if ( qr->filter_categories_size() > 0 ) {
-		for (auto i=0; i < qr->filter_categories_size() ; ++i) {
-			xtmp << XAP_FORMAT_SPPL << XAP_CATEGORY_PREFIX << qr->filter_categories(i);
-		}
+	WordVecT terms;
+	for (size_t i=0; i<wordstr.size(); ++i) {
+		if ( ( qtype == ALL_PARTIAL ) || ( qtype == LAST_PARTIAL && i==(wordstr.size()-1) ) )
+			terms.emplace_back( part_prefix + wordstr.at(i) );
+		else
+			terms.emplace_back( full_prefix + wordstr.at(i) );
 	}
 
-	if ( qr->filter_tags_size() > 0 ) {
-		for (auto i=0; i < qr->filter_tags_size() ; ++i) {
-			xtmp << XAP_FORMAT_SPPL << XAP_TAG_PREFIX << FormatTag(qr->filter_tags(i).name(), qr->filter_tags(i).value() );
-		}
-	}
+	for (auto i=0; i < qr->limit_terms_size() ; ++i)
+		terms.emplace_back( qr->limit_terms(i) );
+	if ( !qr->begin_word().empty() )
+		terms.emplace_back( ( ( qr->begin_part() ) ? XAP_BEGINPART_PREFIX : XAP_BEGINFULL_PREFIX ) + qr->begin_word() );
 
-	unsigned int flags =
-	    Xapian::QueryParser::FLAG_LOVEHATE
-	    | Xapian::QueryParser::FLAG_BOOLEAN
-	    ;
-	Xapian::QueryParser queryparser;
-	queryparser.set_database(db);
-	Xapian::Enquire enquire(db);
-	enquire.set_weighting_scheme(Xapian::BoolWeight());
+	for (auto i=0; i < qr->filter_categories_size() ; ++i)
+		terms.emplace_back( XAP_CATEGORY_PREFIX + qr->filter_categories(i) );
 
-	Xapian::Query query = queryparser.parse_query(xtmp.str(), flags);
-	enquire.set_query(query);
+	for (auto i=0; i < qr->filter_tags_size() ; ++i)
+		terms.emplace_back( XAP_TAG_PREFIX + FormatTag(qr->filter_tags(i).name(), qr->filter_tags(i).value() ) );
 
-	Xapian::LatLongCoord centre( qr->location().lat(), qr->location().lon() );
-	zpds::search::DistanceSlabKeyMaker keymaker(XAP_LATLON_POS, XAP_IMPORTANCE_POS, centre, qr->distance_band(), qr->distance_def() );
-	enquire.set_sort_by_key(&keymaker, false);
+	std::sort(terms.begin(), terms.end());
+	terms.erase( std::unique(terms.begin(), terms.end()), terms.end() );
+	return terms;
+}
 
-	Xapian::MSet mset;
-	mset = enquire.get_mset(0,qr->items());
-	if (mset.size()>0) {
-		for (Xapian::MSetIterator m = mset.begin(); m != mset.end(); ++m) {
-			qr->add_ids( boost::lexical_cast<uint64_t>( m.get_document().get_value( XAP_ROCKSID_POS )) );
-			qr->add_sortkeys( m.get_sort_key() );
-		}
+
+/**
+* GetGeoRings: geohash filters widening around a point
+*
+*/
+zpds::search::SearchBase::GeoRingVecT zpds::search::SearchBase::GetGeoRings(double lat, double lon) const
+{
+	GeoRingVecT rings;
+	std::string hash;
+	try {
+		hash = gh.Encode( lat, lon, 7);
 	}
-	return (mset.size()>0);
+	catch (::zpds::BaseException& e) {
+		return rings;
+	}
+
+	// cell of 7 and its neighbours
+	auto nbrs = gh.GetNeighbours(hash, 1);
+	if (nbrs.size()>0) {
+		std::vector<Xapian::Query> terms { Xapian::Query( FormatPrefix( hash, XAP_GEOHASH7_PREFIX ) ) };
+		for (auto& it : nbrs) terms.emplace_back( FormatPrefix( it, XAP_GEOHASH7_PREFIX ) );
+		rings.push_back( { Xapian::Query( Xapian::Query::OP_OR, terms.begin(), terms.end() ), gh.InnerRadiusM( lat, lon, hash, 1) } );
+	}
+
+	// two level neighbourhood of 5 , one level neighbourhood of 3 , as indexed
+	rings.push_back( { Xapian::Query( FormatPrefix( hash.substr(0,5), XAP_NBRHASH5_PREFIX ) ), gh.InnerRadiusM( lat, lon, hash.substr(0,5), 2) } );
+	rings.push_back( { Xapian::Query( FormatPrefix( hash.substr(0,3), XAP_NBRHASH3_PREFIX ) ), gh.InnerRadiusM( lat, lon, hash.substr(0,3), 1) } );
+	return rings;
 }
 
 /**
-* FindFull: check if exists
+* FindNear: check if exists nearby
 *
 */
-bool zpds::search::SearchBase::FindFull(::zpds::search::UsedParamsT* qr,bool reset)
+bool zpds::search::SearchBase::FindNear(::zpds::search::UsedParamsT* qr, bool reset)
 {
 
-	auto db = Get(qr->lang(), qr->dtyp() );
+	auto& db = Get(qr->lang(), qr->dtyp() );
 	auto wordstr_size = wordstr.size();
+	if (qr->location().dont_use()) return false;
 	if (reset) wordstr_size = SetQuery(qr->query());
-	if (wordstr_size==0) return false;
-
-	QueryWordsE qtype = ( qr->all_partial() ) ? ALL_PARTIAL : ( qr->last_partial() ) ? LAST_PARTIAL : FULL_WORDS;
 
-	std::string full_prefix { XAP_FORMAT_PLUS };
-	std::string part_prefix { XAP_FORMAT_PLUS XAP_PARTWORD_PREFIX };
-	if ( qr->use_name() ) {
-		full_prefix = std::string(XAP_FORMAT_PLUS XAP_NAMEFULL_PREFIX);
-		part_prefix = std::string(XAP_FORMAT_PLUS XAP_NAMEPART_PREFIX);
-	}
+	if ( (! qr->noname() ) && ( wordstr_size==0) ) return false;
 
-	std::ostringstream xtmp;
-	xtmp << GetQueryString( qtype, qr->extra(), full_prefix, part_prefix);
+	auto& enquire = GetTools(qr->lang(), qr->dtyp() ).enquire;
+	Xapian::Query query = GetQuery( qr );
 
-	if ( qr->filter_categories_size() > 0 ) {
-		for (auto i=0; i < qr->filter_categories_size() ; ++i) {
-			xtmp << XAP_FORMAT_SPPL << XAP_CATEGORY_PREFIX << qr->filter_categories(i);
+	Xapian::LatLongCoord centre( qr->location().lat(), qr->location().lon() );
+	auto column = GetGeoColumn(qr->lang(), qr->dtyp());
+	zpds::search::DistanceSlabKeyMaker keymaker(XAP_LATLON_POS, XAP_IMPORTANCE_POS, centre, qr->distance_band(), qr->distance_def(),
+	        XAP_DSLAB_MAX_DISTANCE, column );
+	bool batch = ( column && DistanceSlabBatch::CanUse( qr->distance_band(), XAP_DSLAB_MAX_DISTANCE ) );
+
+	// top items by key then docid , scored in blocks if columns are there
+	auto rank = [&](const Xapian::Query& q) -> DistanceSlabBatch::ScoreVecT {
+		enquire.set_query(q);
+		if (batch) {
+			DistanceSlabBatch scorer(centre, qr->distance_band(), qr->distance_def(), XAP_DSLAB_MAX_DISTANCE, column, qr->items() );
+			enquire.set_sort_by_relevance();
+			enquire.get_mset(0, 1, db.get_doccount(), nullptr, &scorer);
+			return scorer.Finish();
+		}
+		DistanceSlabBatch::ScoreVecT scores;
+		enquire.set_sort_by_key(&keymaker, false);
+		Xapian::MSet mset = enquire.get_mset(0,qr->items());
+		for (Xapian::MSetIterator m = mset.begin(); m != mset.end(); ++m)
+			scores.push_back( { Xapian::sortable_unserialise( m.get_sort_key() ), *m } );
+		return scores;
+	};
+
+	// lowest key a document at least dist away can get, same slabs as keymaker
+	int slab = KeepInBound<int>( qr->distance_band(), 1, XAP_DSLAB_MAX_DISTANCE );
+	auto keyfloor = [&](double dist) -> double {
+		int d = KeepInBound<int>( (int)std::min<double>( std::floor(dist), XAP_DSLAB_MAX_DISTANCE ), 0, XAP_DSLAB_MAX_DISTANCE );
+		return (double)( (1 + d/slab) * XAP_DSLAB_MAX_IMPORTANCE );
+	};
+
+	// documents without geohash terms are never inside a ring : no location, at 0,0 or near the poles
+	double untermed = keyfloor( KeepInBound<int>( qr->distance_def(), 0, XAP_DSLAB_MAX_DISTANCE ) );
+	untermed = std::min( untermed, keyfloor( Xapian::GreatCircleMetric()( centre, Xapian::LatLongCoord(0.0, 0.0) ) ) );
+	untermed = std::min( untermed, keyfloor( gh.Deg2Rad( ZPDS_ALLOWED_MAX_LAT - std::fabs( qr->location().lat() ) ) * ZPDS_EARTH_RADIUS_M ) );
+
+	// widen the rings till the last of top items sorts before anything outside
+	DistanceSlabBatch::ScoreVecT scores;
+	bool complete = false;
+	if ( qr->items() > 0 && untermed > XAP_DSLAB_MAX_IMPORTANCE ) {
+		for (auto& ring : GetGeoRings( qr->location().lat(), qr->location().lon() ) ) {
+			double bound = std::min( keyfloor( ring.radius ), untermed );
+			if ( bound <= XAP_DSLAB_MAX_IMPORTANCE ) continue;
+			scores = rank( Xapian::Query( Xapian::Query::OP_FILTER, query, ring.filter ) );
+			if ( scores.size() < qr->items() ) continue;
+			if ( scores.back().key < bound ) {
+				complete = true;
+				break;
+			}
 		}
 	}
 
-	if ( qr->filter_tags_size() > 0 ) {
-		for (auto i=0; i < qr->filter_tags_size() ; ++i) {
-			xtmp << XAP_FORMAT_SPPL << XAP_TAG_PREFIX << FormatTag(qr->filter_tags(i).name(), qr->filter_tags(i).value() );
-		}
+	if (!complete) scores = rank(query);
+	for (auto& score : scores) {
+		qr->add_ids( boost::lexical_cast<uint64_t>( db.get_document( score.did ).get_value( XAP_ROCKSID_POS )) );
+		qr->add_sortkeys( Xapian::sortable_serialise( score.key ) );
 	}
+	return (scores.size()>0);
+}
+
+/**
+* FindFull: check if exists
+*
+*/
+bool zpds::search::SearchBase::FindFull(::zpds::search::UsedParamsT* qr,bool reset)
+{
 
-	unsigned int flags =
-	    Xapian::QueryParser::FLAG_LOVEHATE
-	    | Xapian::QueryParser::FLAG_BOOLEAN
-	    ;
-	Xapian::QueryParser queryparser;
-	queryparser.set_database(db);
-	Xapian::Enquire enquire(db);
-	enquire.set_weighting_scheme(Xapian::BoolWeight());
+	auto wordstr_size = wordstr.size();
+	if (reset) wordstr_size = SetQuery(qr->query());
+	if (wordstr_size==0) return false;
 
-	Xapian::Query query = queryparser.parse_query(xtmp.str(), flags);
+	auto& enquire = GetTools(qr->lang(), qr->dtyp() ).enquire;
+	Xapian::Query query = GetQuery( qr );
 	enquire.set_query(query);
 	enquire.set_sort_by_value(XAP_IMPORTANCE_POS,true);
 
@@ -246,10 +363,10 @@ bool zpds::search::SearchBase::FindFull(::zpds::search::UsedParamsT* qr,bool res
 }
 
 /**
-* RuleSearch : do the search from rule, populate ids to cresp
+* PrepareRule : set params from rule , check if rule applies
 *
 */
-bool zpds::search::SearchBase::RuleSearch (
+bool zpds::search::SearchBase::PrepareRule (
     ::zpds::search::UsedParamsT* params, const ::zpds::search::QueryRuleT* rule)
 {
 
@@ -260,7 +377,10 @@ bool zpds::search::SearchBase::RuleSearch (
 
 	DLOG(INFO) << params->DebugString();
 
-	std::ostringstream extra;
+	// limit and begin with terms go as terms , set afresh for each rule
+	params->clear_limit_terms();
+	params->clear_begin_word();
+	params->clear_begin_part();
 
 	// input_type
 	switch ( rule->input_type() ) {
@@ -282,39 +402,39 @@ bool zpds::search::SearchBase::RuleSearch (
 		break;
 	case zpds::search::LimitTypeE::L_CCODE:
 		if ( params->location().ccode().empty() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().ccode(), XAP_CCODE_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().ccode(), XAP_CCODE_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_CITY:
 		if ( params->location().city().empty() || params->location().ccode().empty() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().city() + params->location().ccode(), XAP_CITY_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().city() + params->location().ccode(), XAP_CITY_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_PINCODE:
 		if ( params->location().pincode().empty() || params->location().ccode().empty() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().pincode() + params->location().ccode(), XAP_PINCODE_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().pincode() + params->location().ccode(), XAP_PINCODE_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_GEOHASH3:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,3), XAP_GEOHASH3_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,3), XAP_GEOHASH3_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_GEOHASH5:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,5), XAP_GEOHASH5_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,5), XAP_GEOHASH5_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_GEOHASH7:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,7), XAP_GEOHASH7_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,7), XAP_GEOHASH7_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_GEOHASH9:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,9), XAP_GEOHASH9_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,9), XAP_GEOHASH9_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_NBRHASH3:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,3), XAP_NBRHASH3_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,3), XAP_NBRHASH3_PREFIX ) );
 		break;
 	case zpds::search::LimitTypeE::L_NBRHASH5:
 		if ( params->location().dont_use() ) return false;
-		extra << XAP_FORMAT_SPPL + FormatPrefix( params->location().geohash().substr(0,5), XAP_NBRHASH5_PREFIX );
+		params->add_limit_terms( FormatPrefix( params->location().geohash().substr(0,5), XAP_NBRHASH5_PREFIX ) );
 		break;
 	}
 
@@ -326,12 +446,8 @@ bool zpds::search::SearchBase::RuleSearch (
 	case zpds::search::SearchTypeE::S_BEGINWITH: {
 		auto ss = ::zpds::utils::SplitWith::Space ( params->query() );
 		if ( ss.size() >0) {
-			extra << XAP_FORMAT_SPPL;
-			if ( ( params->all_partial() ) || ( params->last_partial() && ss.size()==1 ) )
-				extra << XAP_BEGINPART_PREFIX;
-			else
-				extra << XAP_BEGINFULL_PREFIX;
-			extra << ss.front();
+			params->set_begin_word( ss.front() );
+			params->set_begin_part( ( params->all_partial() ) || ( params->last_partial() && ss.size()==1 ) );
 		}
 		break;
 	}
@@ -348,29 +464,77 @@ bool zpds::search::SearchBase::RuleSearch (
 		// end switch
 	}
 
-	// set the extra
-	params->set_extra( extra.str() );
-
 	DLOG(INFO) << params->DebugString();
 
-	uint64_t currtime = ZPDS_CURRTIME_MS;
 	// order_type
 	switch ( rule->order_type() ) {
 	default:
 	case zpds::search::OrderTypeE::O_DEFAULT:
-		FindFull( params, true );
 		break;
 	case zpds::search::OrderTypeE::O_DIST_BAND:
 		if (params->location().dont_use()) return false;
-		FindNear( params, true );
 		break;
 	case zpds::search::OrderTypeE::O_DIST_ONLY:
 		if (params->location().dont_use()) return false;
 		params->set_distance_band ( 10 );
+		break;
+	}
+	return true;
+}
+
+/**
+* FindPrefix: answer a one word partial query from prefix top documents
+*
+*/
+bool zpds::search::SearchBase::FindPrefix(::zpds::search::UsedParamsT* qr)
+{
+	Get(qr->lang(), qr->dtyp() );
+	auto prefix = GetPrefixTopK(qr->lang(), qr->dtyp());
+	if (!prefix) return false;
+	if ( SetQuery(qr->query()) == 0 ) return false;
+
+	PrefixTopK::EntryVecT entries;
+	if (! prefix->Find( GetQueryTerms(qr), qr->items(), entries ) ) return false;
+	for (auto& entry : entries) {
+		qr->add_ids( entry.id );
+		qr->add_sortkeys( entry.key );
+	}
+	return true;
+}
+
+/**
+* RuleSearch : do the search from rule, populate ids to cresp
+*
+*/
+bool zpds::search::SearchBase::RuleSearch (
+    ::zpds::search::UsedParamsT* params, const ::zpds::search::QueryRuleT* rule)
+{
+	if (! PrepareRule( params, rule) ) return false;
+
+	// order_type
+	switch ( rule->order_type() ) {
+	default:
+	case zpds::search::OrderTypeE::O_DEFAULT:
+		if ( rule->input_type() != zpds::search::InputTypeE::I_ONEWORD || !FindPrefix( params ) )
+			FindFull( params, true );
+		break;
+	case zpds::search::OrderTypeE::O_DIST_BAND:
+	case zpds::search::OrderTypeE::O_DIST_ONLY:
 		FindNear( params, true );
 		break;
 	}
 
+	ScoreRule( params, rule );
+	return true;
+}
+
+/**
+* ScoreRule : scores from sortkeys as per rule order
+*
+*/
+void zpds::search::SearchBase::ScoreRule (
+    ::zpds::search::UsedParamsT* params, const ::zpds::search::QueryRuleT* rule)
+{
 	constexpr double dsmax = XAP_DSLAB_MAX_IMPORTANCE * XAP_DSLAB_MAX_DISTANCE;
 
 	if (params->ids_size() != params->sortkeys_size())
@@ -394,8 +558,82 @@ bool zpds::search::SearchBase::RuleSearch (
 
 	if (params->ids_size() != params->scores_size())
 		throw ::zpds::BadCodeException("ids dont match scores");
+}
 
-	return true;
+/**
+* FuseRules : run rules ordered by importance in one pass over a query built for all
+*
+*/
+size_t zpds::search::SearchBase::FuseRules(
+    const ::zpds::search::UsedParamsT* qr, const ::zpds::search::QueryProfT* qprof,
+    std::vector<UsedParamsT>& nqrs, std::vector<bool>& done)
+{
+	nqrs.assign( qprof->rules_size(), *qr );
+	done.assign( qprof->rules_size(), false );
+	if ( SetQuery(qr->query()) == 0 ) return 0;
+
+	// distance orders keep their own path , one word rules may not need the index
+	size_t ndone = 0;
+	std::vector<int> fused;
+	std::vector<WordVecT> rterms;
+	for (auto k = 0 ; k < qprof->rules_size() ; ++k ) {
+		auto rule = &qprof->rules(k);
+		if ( rule->order_type() == zpds::search::OrderTypeE::O_DIST_BAND
+		        || rule->order_type() == zpds::search::OrderTypeE::O_DIST_ONLY ) continue;
+		if (! PrepareRule( &nqrs[k], rule ) ) continue;
+		// parts expanded as wildcards have no postings to tag with , these run alone
+		if ( PartsOverLimit( &nqrs[k] ) ) continue;
+		if ( rule->input_type() == zpds::search::InputTypeE::I_ONEWORD && FindPrefix( &nqrs[k] ) ) {
+			ScoreRule( &nqrs[k], rule );
+			done[k] = true;
+			++ndone;
+			continue;
+		}
+		fused.push_back(k);
+		rterms.emplace_back( GetQueryTerms( &nqrs[k] ) );
+	}
+	if ( fused.size() < 2 ) return ndone;
+
+	// terms every rule needs are matched by xapian , the rest only tag the rules
+	WordVecT common = rterms.front();
+	for (auto& terms : rterms ) {
+		WordVecT both;
+		std::set_intersection( common.begin(), common.end(), terms.begin(), terms.end(), std::back_inserter(both) );
+		common.swap(both);
+	}
+
+	auto& db = Get(qr->lang(), qr->dtyp() );
+	zpds::search::RuleTagger tagger(db, XAP_IMPORTANCE_POS);
+	std::vector<Xapian::Query> branches;
+	bool anyrest = false;
+	for (size_t r = 0 ; r < fused.size() ; ++r ) {
+		WordVecT rest;
+		std::set_difference( rterms[r].begin(), rterms[r].end(), common.begin(), common.end(), std::back_inserter(rest) );
+		tagger.AddRule( rest, nqrs[ fused[r] ].items() );
+		if ( rest.empty() ) anyrest = true;
+		else branches.emplace_back( Xapian::Query::OP_AND, rest.begin(), rest.end() );
+	}
+
+	Xapian::Query query( Xapian::Query::OP_AND, common.begin(), common.end() );
+	if ( !anyrest ) {
+		Xapian::Query alts( Xapian::Query::OP_OR, branches.begin(), branches.end() );
+		query = ( common.empty() ) ? alts : Xapian::Query( Xapian::Query::OP_AND, query, alts );
+	}
+
+	auto& enquire = GetTools(qr->lang(), qr->dtyp() ).enquire;
+	enquire.set_query(query);
+	enquire.get_mset(0, 1, db.get_doccount(), nullptr, &tagger);
+
+	for (size_t r = 0 ; r < fused.size() ; ++r ) {
+		auto k = fused[r];
+		for (auto& score : tagger.Finish(r) ) {
+			nqrs[k].add_ids( boost::lexical_cast<uint64_t>( db.get_document( score.did ).get_value( XAP_ROCKSID_POS )) );
+			nqrs[k].add_sortkeys( score.key );
+		}
+		ScoreRule( &nqrs[k], &qprof->rules(k) );
+		done[k] = true;
+	}
+	return ndone + fused.size();
 }
 
 /**
@@ -444,17 +682,37 @@ void zpds::search::SearchBase::SearchByProfile(
 	qr->set_items( counter );
 
 	std::string corrected;
+	std::string q ;
 
 	if ( ! qr->noname() ) {
 		// set last partial
 		qr->set_last_partial( qr->raw_query().back() != ' ' );
 		// set full words if not already set
 		if ( ! qr->full_words() ) qr->set_full_words(! qr->last_partial() );
-		std::string q ;
 		size_t wc =0 ;
 		std::tie(q,wc ) = FlattenCount( qr->raw_query() );
-		auto pos = q.find_last_of(XAP_FORMAT_SPACE);
 		qr->set_no_of_words( wc );
+		qr->set_query( StemQuery( q, (!qr->full_words()) ));
+		if ( qr->no_of_words() == 0 ) return;
+	}
+
+	// same input from the same cell gets the same ids till the index is committed
+	auto rcache = stptr->xapresults;
+	std::string rkey;
+	uint64_t generation = 0;
+	if ( rcache && stptr->xapdb ) {
+		rkey = GetResultKey( qprof, qr );
+		generation = stptr->xapdb->GetGeneration();
+		::zpds::search::ResultCache::IdVecT ids;
+		if ( rcache->Get( rkey, generation, ids ) ) {
+			auto cresp = resp->mutable_cresp();
+			for (auto& id : ids ) cresp->add_records()->set_id( id );
+			return;
+		}
+	}
+
+	if ( ! qr->noname() ) {
+		auto pos = q.find_last_of(XAP_FORMAT_SPACE);
 		// set corrected
 		if ( qr->full_words() ) {
 			corrected = stptr->jamdb->Correct(qr->lang(), q);
@@ -466,10 +724,9 @@ void zpds::search::SearchBase::SearchByProfile(
 			// dont correct anything if one word partial
 		}
 		if (q==corrected) corrected.clear();
-		qr->set_query( StemQuery( q, (!qr->full_words()) ));
-		if ( qr->no_of_words() == 0 ) return;
 	}
 
+	SearchContext::Scope ctx;
 	uint64_t rule_weight = 0;
 	std::unordered_set<uint64_t> idset;
 	std::map<std::string, uint64_t> idmap;
@@ -483,20 +740,51 @@ void zpds::search::SearchBase::SearchByProfile(
 			qr->set_query( StemQuery( corrected, (!qr->full_words()) ));
 		}
 
-		for (auto i = 0 ; i < qprof->rules_size() ; ++i ) {
-			auto rule = qprof->mutable_rules(i);
-			if (rule_weight > rule->weight() && idset.size() >= counter)
+		// rules ordered by importance can share one pass
+		auto& fqrs = ctx->fused;
+		auto& done = ctx->done;
+		done.assign( qprof->rules_size(), false );
+		if ( stptr->fuse_rules.Get() ) FuseRules( qr, qprof, fqrs, done );
+
+		for (auto i = 0 ; i < qprof->rules_size() ; ) {
+			const uint64_t weight = qprof->rules(i).weight();
+			// lower weight rules are not started once there are enough
+			if (rule_weight > weight && idset.size() >= counter)
 				break;
-			auto nqr =*qr;
-			bool status = RuleSearch(&nqr, rule);
-			for (auto j = 0 ; j < nqr.ids_size() ; ++j ) {
-				if (idset.find( nqr.ids(j) ) != idset.end() ) continue;
-				idset.emplace( nqr.ids(j) );
-				idmap.emplace(
-				    EncodeSortKey<uint64_t, double, uint64_t>( rule->weight(), nqr.scores(j), nqr.ids(j) ),
-				    nqr.ids(j) );
+
+			// rules of equal weight run together , merged in rule order as if run one by one
+			auto end = i+1;
+			while ( end < qprof->rules_size() && qprof->rules(end).weight() == weight ) ++end;
+			auto& nqrs = ctx->group;
+			auto& todo = ctx->todo;
+			nqrs.assign( end - i, *qr );
+			todo.clear();
+			for (auto k = i ; k < end ; ++k ) {
+				if ( done[k] ) nqrs[k-i].Swap( &fqrs[k] );
+				else todo.push_back(k);
+			}
+			if ( pool && todo.size() > 1 ) {
+				auto rpool = pool;
+				async::parallel_for(todo, [rpool, qprof, &nqrs, i](int k) {
+					RuleWorker worker(rpool);
+					worker.RuleSearch( &nqrs[k-i], &qprof->rules(k) );
+				});
+			}
+			else {
+				for (auto k : todo ) RuleSearch( &nqrs[k-i], &qprof->rules(k) );
+			}
+
+			for (auto& nqr : nqrs) {
+				for (auto j = 0 ; j < nqr.ids_size() ; ++j ) {
+					if (idset.find( nqr.ids(j) ) != idset.end() ) continue;
+					idset.emplace( nqr.ids(j) );
+					idmap.emplace(
+					    EncodeSortKey<uint64_t, double, uint64_t>( weight, nqr.scores(j), nqr.ids(j) ),
+					    nqr.ids(j) );
+				}
 			}
-			rule_weight = rule->weight();
+			rule_weight = weight;
+			i = end;
 		}
 
 	}
@@ -504,7 +792,60 @@ void zpds::search::SearchBase::SearchByProfile(
 	// populate from db
 	auto ncounter = counter;
 	auto cresp = resp->mutable_cresp();
+	::zpds::search::ResultCache::IdVecT ids;
 	for (auto it = idmap.rbegin() ; it != idmap.rend() ; ++it ) {
 		cresp->add_records()->set_id( it->second );
+		ids.push_back( it->second );
+	}
+	if ( !rkey.empty() ) rcache->Put( rkey, generation, ids );
+}
+
+/**
+* GetResultKey : key of inputs that decide the ids of a profile search
+*
+*/
+std::string zpds::search::SearchBase::GetResultKey(
+    const ::zpds::search::QueryProfT* qprof, const ::zpds::search::UsedParamsT* qr)
+{
+	// location only as fine as the rules use it , exact centre if any rule orders by distance
+	size_t hashlen = 0;
+	bool exact = false;
+	for (auto i = 0 ; i < qprof->rules_size() ; ++i ) {
+		const auto& rule = qprof->rules(i);
+		if ( rule.order_type() == zpds::search::OrderTypeE::O_DIST_BAND
+		        || rule.order_type() == zpds::search::OrderTypeE::O_DIST_ONLY ) exact = true;
+		switch ( rule.limit_type() ) {
+		default:
+			break;
+		case zpds::search::LimitTypeE::L_GEOHASH3:
+		case zpds::search::LimitTypeE::L_NBRHASH3:
+			hashlen = std::max<size_t>( hashlen, 3 );
+			break;
+		case zpds::search::LimitTypeE::L_GEOHASH5:
+		case zpds::search::LimitTypeE::L_NBRHASH5:
+			hashlen = std::max<size_t>( hashlen, 5 );
+			break;
+		case zpds::search::LimitTypeE::L_GEOHASH7:
+			hashlen = std::max<size_t>( hashlen, 7 );
+			break;
+		case zpds::search::LimitTypeE::L_GEOHASH9:
+			hashlen = std::max<size_t>( hashlen, 9 );
+			break;
+		}
+	}
+
+	// raw query is as stemmed
+	::zpds::search::UsedParamsT kp(*qr);
+	kp.clear_raw_query();
+	kp.clear_ids();
+	kp.clear_sortkeys();
+	kp.clear_scores();
+	auto loc = kp.mutable_location();
+	if (!exact) {
+		loc->clear_lat();
+		loc->clear_lon();
+		loc->set_geohash( ( loc->dont_use() ) ? std::string() : loc->geohash().substr(0,hashlen) );
 	}
+	std::string prof = qprof->SerializeAsString();
+	return std::to_string( prof.size() ) + XAP_FORMAT_SPACE + prof + kp.SerializeAsString();
 }
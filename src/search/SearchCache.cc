@@ -46,6 +46,15 @@ zpds::search::SearchCache::SearchCache(const std::string& dbpath_)
 {
 }
 
+/**
+* Constructor : with shared reader pool
+*
+*/
+zpds::search::SearchCache::SearchCache(ReaderPool::pointer pool_)
+	: ReadIndex(pool_)
+{
+}
+
 /**
 * destructor
 */
@@ -58,7 +67,7 @@ zpds::search::SearchCache::~SearchCache () {}
 void zpds::search::SearchCache::WarmCache(::zpds::search::LangTypeE lang, ::zpds::search::IndexTypeE dtyp, size_t modno, size_t outof)
 {
 
-	auto db = Get(lang, dtyp );
+	auto& tools = GetTools(lang, dtyp );
 	zpds::search::SearchCache::WordVecT wvec ;
 
 	if (outof>modno) {
@@ -84,34 +93,28 @@ void zpds::search::SearchCache::WarmCache(::zpds::search::LangTypeE lang, ::zpds
 			}
 		}
 	}
-	DoWarmCache(db,wvec);
+	DoWarmCache(tools,wvec);
 }
 
 /**
 * DoWarmCache : warms up cache for a set of words
 *
 */
-void zpds::search::SearchCache::DoWarmCache(::zpds::search::SearchCache::DatabaseT& db, zpds::search::SearchCache::WordVecT wvec)
+void zpds::search::SearchCache::DoWarmCache(::zpds::search::ReaderPool::ToolsT& tools, zpds::search::SearchCache::WordVecT wvec)
 {
 
 	WordVecT pvec { XAP_BEGINFULL_PREFIX, XAP_BEGINPART_PREFIX, "", XAP_PARTWORD_PREFIX, XAP_NAMEFULL_PREFIX, XAP_NAMEPART_PREFIX};
 
-	unsigned int flags = Xapian::QueryParser::FLAG_LOVEHATE;
-
-	Xapian::QueryParser queryparser;
-	queryparser.set_database(db);
-	Xapian::Enquire enquire(db);
-	enquire.set_weighting_scheme(Xapian::BoolWeight());
+	auto& enquire = tools.enquire;
 
 	size_t counter =0;
 	for (auto& word : wvec) {
 		++counter;
 		uint64_t currtime = ZPDS_CURRTIME_MS;
+		auto tword = boost::algorithm::to_lower_copy(word);
+		boost::algorithm::trim(tword);
 		for (auto& prefix : pvec) {
-			auto tword = boost::algorithm::to_lower_copy(word);
-			boost::algorithm::trim(tword);
-			std::string xtmp = std::string("+") + prefix + tword;
-			Xapian::Query query = queryparser.parse_query(xtmp, flags);
+			Xapian::Query query( prefix + tword );
 
 			{
 				enquire.set_query(query);
@@ -0,0 +1,69 @@
+/**
+ * @project zapdos
+ * @file src/search/SearchContext.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  SearchContext.cc : Per thread reusable search scratch impl
+ *
+ */
+#include "search/SearchContext.hpp"
+
+static thread_local std::vector<zpds::search::SearchContext::pointer> idle_contexts;
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::search::SearchContext::SearchContext() {}
+
+/**
+ * Destructor : default
+ *
+ */
+zpds::search::SearchContext::~SearchContext() {}
+
+/**
+* Acquire : an idle context of this thread , new if none
+*
+*/
+zpds::search::SearchContext::pointer zpds::search::SearchContext::Acquire()
+{
+	if ( idle_contexts.empty() ) return pointer( new SearchContext() );
+	pointer ctx = std::move( idle_contexts.back() );
+	idle_contexts.pop_back();
+	return ctx;
+}
+
+/**
+* Release : return a context to this thread for reuse
+*
+*/
+void zpds::search::SearchContext::Release(pointer&& ctx)
+{
+	if ( ctx && idle_contexts.size() < XAP_SEARCH_CONTEXT_KEEP ) idle_contexts.emplace_back( std::move(ctx) );
+	ctx.reset();
+}
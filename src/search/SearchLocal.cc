@@ -33,18 +33,16 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <map>
-#include <regex>
-#include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include "search/SearchLocal.hpp"
+#include "search/PhotonProjection.hpp"
 #include "utils/SplitWith.hpp"
 #include "utils/PrintWith.hpp"
 
 #include "store/LocalDataService.hpp"
 
 const ::zpds::store::LocalDataService ldserv;
-const std::regex bbox_regex("BOX\\(([0-9\\-\\.]*) ([0-9\\-\\.]*),([0-9\\-\\.]*) ([0-9\\-\\.]*)\\)");
 
 /**
 * Constructor : with query
@@ -55,6 +53,15 @@ zpds::search::SearchLocal::SearchLocal(const std::string& dbpath_)
 {
 }
 
+/**
+* Constructor : with shared reader pool
+*
+*/
+zpds::search::SearchLocal::SearchLocal(ReaderPool::pointer pool_)
+	: ReadIndex(pool_)
+{
+}
+
 /**
 * destructor
 */
@@ -85,54 +92,39 @@ void zpds::search::SearchLocal::CompletionQueryAction(::zpds::utils::SharedTable
 
 	SearchByProfile(stptr, &qprof, resp);
 
-	// populate result
-	ldserv.GetManyRecords(stptr, resp->mutable_cresp()->mutable_records() );
-
 	auto pdata = resp->mutable_photondata();
 	auto cresp = resp->mutable_cresp();
-
 	pdata->set_type( "FeatureCollection" );
-	size_t populated = 0;
-	for (auto i = 0 ; i < cresp->records_size() ; ++i )
-	{
-		if ( cresp->records(i).notfound() ) continue; // not probable
-		auto feat = pdata->add_features() ;
-		feat->set_type( "Feature" );
-
-		auto prop = feat->mutable_properties();
-		prop->set_osm_id( cresp->records(i).osm_id() );
-		prop->set_osm_key( cresp->records(i).osm_key() );
-		prop->set_osm_value( cresp->records(i).osm_value() );
-		prop->set_osm_type( cresp->records(i).osm_type() );
-		prop->set_city( cresp->records(i).city() );
-		prop->set_country( cresp->records(i).country() );
-		prop->set_state( cresp->records(i).state() );
-		prop->set_name( ::zpds::utils::PrintWithComma::String( cresp->records(i).fld_name(), cresp->records(i).fld_area() ) );
-		prop->set_address( cresp->records(i).address() );
-		prop->set_postcode( cresp->records(i).pincode() );
-		prop->set_area( cresp->records(i).fld_area() );
 
-		// TODO : extents
-		if ( ! cresp->records(i).geometry().empty() ) {
-			try {
-				std::smatch sm;
-				if ( std::regex_search( cresp->records(i).geometry(), sm, bbox_regex) ) {
-					if (sm.size()==5) {
-						prop->add_extent( boost::lexical_cast<double>(sm.str(1) ) );
-						prop->add_extent( boost::lexical_cast<double>(sm.str(2) ) );
-						prop->add_extent( boost::lexical_cast<double>(sm.str(3) ) );
-						prop->add_extent( boost::lexical_cast<double>(sm.str(4) ) );
-					}
-				}
+	// populate result from the projection kept in the index , store only for those without
+	// records not found are left out , so take more till counter are populated
+	auto& db = Get(qr->lang(), qr->dtyp() );
+	::zpds::query::PhotonResultT loaded;
+	int next = 0;
+	while ( (uint64_t)loaded.features_size() < counter && next < cresp->records_size() ) {
+		int upto = std::min<int>( cresp->records_size(), next + (counter - loaded.features_size()) );
+		::zpds::query::PhotonResultT batch;
+		::zpds::query::ItemResultT missing;
+		std::vector<bool> inindex;
+		for ( ; next < upto ; ++next ) {
+			auto feat = batch.add_features();
+			inindex.push_back( PhotonProjection::Load( db, cresp->records(next).id(), feat ) );
+			if ( inindex.back() ) continue;
+			feat->Clear();
+			missing.add_records()->set_id( cresp->records(next).id() );
+		}
+		// index written before projections were kept
+		if ( missing.records_size() > 0 )
+			ldserv.GetManyRecords(stptr, missing.mutable_records() );
+		for (size_t i = 0, j = 0 ; i < inindex.size() ; ++i ) {
+			if ( inindex[i] ) {
+				loaded.add_features()->Swap( batch.mutable_features(i) );
+				continue;
 			}
-			catch (std::exception& e) {}
+			const auto& record = missing.records(j++);
+			if ( record.notfound() ) continue; // not probable
+			PhotonProjection::Make( &record, loaded.add_features() );
 		}
-
-		auto geom = feat->mutable_geometry();
-		geom->set_type( "Point" );
-		geom->add_coordinates( cresp->records(i).lon() );
-		geom->add_coordinates( cresp->records(i).lat() );
-
-		if (++populated >= counter) break;
 	}
+	pdata->mutable_features()->Swap( loaded.mutable_features() );
 }
@@ -53,6 +53,15 @@ zpds::search::SearchWiki::SearchWiki(const std::string& dbpath_)
 {
 }
 
+/**
+* Constructor : with shared reader pool
+*
+*/
+zpds::search::SearchWiki::SearchWiki(ReaderPool::pointer pool_)
+	: ReadIndex(pool_)
+{
+}
+
 /**
 * destructor
 */
@@ -31,6 +31,7 @@
  *
  */
 #include <cmath>
+#include <fstream>
 
 #include "search/WriteIndex.hpp"
 #include <boost/filesystem.hpp>
@@ -42,16 +43,30 @@
  * Constructor : default
  *
  */
-zpds::search::WriteIndex::WriteIndex(std::string dbpath_)
-	: dbpath(dbpath_)
+zpds::search::WriteIndex::WriteIndex(std::string dbpath_, size_t shards_, int flags_)
+	: dbpath(dbpath_),
+	  shards(shards_),
+	  flags(flags_),
+	  snapshot(std::make_shared<const SnapshotT>( SnapshotT{0, static_cast<uint64_t>(ZPDS_CURRTIME_MS), 0} )),
+	  pending_docs(0), pending_bytes(0), pending_since(0)
 {
 	if (dbpath.empty()) throw zpds::InitialException("dbpath cannot be blank");
+	if (shards==0 || shards > XAP_MAX_SHARDS) throw zpds::InitialException("xapian shards should be 1 to " + std::to_string(XAP_MAX_SHARDS));
+	CheckShards();
 	const google::protobuf::EnumDescriptor *l = zpds::search::LangTypeE_descriptor();
 	const google::protobuf::EnumDescriptor *d = zpds::search::IndexTypeE_descriptor();
 	for (auto i=0 ; i < l->value_count() ; ++i ) {
 		for (auto j=0 ; j < d->value_count() ; ++j ) {
-			Get(::zpds::search::LangTypeE(i), ::zpds::search::IndexTypeE(j) );
-			LOG(INFO) << "Created xap index : " << l->value(i)->name() << "_" << d->value(j)->name();
+			auto ltyp = ::zpds::search::LangTypeE( l->value(i)->number() );
+			auto dtyp = ::zpds::search::IndexTypeE( d->value(j)->number() );
+			ShardVecT& svec = triemap[ (ltyp * 1000) + dtyp ];
+			for (size_t k=0 ; k < shards ; ++k ) {
+				const std::string xapath = ShardPath(dbpath, ltyp, dtyp, k);
+				if (!boost::filesystem::exists(xapath)) boost::filesystem::create_directories(xapath);
+				svec.emplace_back( new ShardT );
+				svec.back()->db = DatabaseT(xapath, flags );
+			}
+			LOG(INFO) << "Created xap index : " << l->value(i)->name() << "_" << d->value(j)->name() << " shards: " << shards;
 		}
 	}
 }
@@ -63,36 +78,206 @@ zpds::search::WriteIndex::WriteIndex(std::string dbpath_)
 zpds::search::WriteIndex::~WriteIndex()
 {
 	for (auto it = triemap.begin() ; it != triemap.end() ; ++it) {
-		it->second.close();
+		for (auto& shard : it->second) shard->db.close();
 	}
 }
 
 /**
-* CommitData : commits data
+* CommitData : commits data , each shard under its own lock
 *
 */
 void zpds::search::WriteIndex::CommitData()
 {
+	std::lock_guard<std::mutex> clock(commit_lock);
+	uint64_t doccount=0;
+	pending_docs.store(0);
+	pending_bytes.store(0);
+	pending_since.store(0);
+	auto current = GetSnapshot();
+	auto clog = std::make_shared<ChangeLogT>();
+	clog->generation = current->generation + 1;
 	for (auto it = triemap.begin() ; it != triemap.end() ; ++it) {
-		it->second.commit();
+		ChangesT& changes = clog->changes[ it->first ];
+		for (auto& shard : it->second) {
+			std::lock_guard<std::mutex> lock(shard->lock);
+			shard->db.commit();
+			doccount += shard->db.get_doccount();
+			// taken under the same lock so the log has exactly what this commit has
+			if (shard->overflow) changes.overflow = true;
+			if (!changes.overflow) changes.idterms.insert(changes.idterms.end(), shard->changed.begin(), shard->changed.end() );
+			shard->changed.clear();
+			shard->overflow = false;
+		}
+		if (changes.overflow) changes.idterms.clear();
+	}
+	{
+		std::lock_guard<std::mutex> lock(change_lock);
+		changelog.emplace_back( std::move(clog) );
+		while (changelog.size() > XAP_CHANGE_KEEP) changelog.pop_front();
+	}
+	std::atomic_store(&snapshot, std::make_shared<const SnapshotT>(
+	                      SnapshotT{current->generation + 1, static_cast<uint64_t>(ZPDS_CURRTIME_MS), doccount} ) );
+}
+
+/**
+* GetGeneration : commit generation
+*
+*/
+uint64_t zpds::search::WriteIndex::GetGeneration() const
+{
+	return GetSnapshot()->generation;
+}
+
+/**
+* GetSnapshot : last published commit snapshot
+*
+*/
+zpds::search::WriteIndex::SnapshotPtrT zpds::search::WriteIndex::GetSnapshot() const
+{
+	return std::atomic_load(&snapshot);
+}
+
+/**
+* Get: get the shard for an idterm
+*
+*/
+zpds::search::WriteIndex::ShardT& zpds::search::WriteIndex::Get(
+    ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const std::string& idterm)
+{
+	auto it = triemap.find( (ltyp * 1000) + dtyp );
+	if ( it == triemap.end() )
+		throw ::zpds::BadCodeException("search index does not exist for this language");
+	return *(it->second.at( ShardNo(idterm, shards) ));
+}
+
+/**
+* GetChanges : idterms changed by commits after one generation upto another
+*
+*/
+bool zpds::search::WriteIndex::GetChanges(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
+        uint64_t after, uint64_t upto, IdTermsT& idterms)
+{
+	if (upto < after) return false;
+	int f = ltyp * 1000 + dtyp;
+	uint64_t found = 0;
+	std::lock_guard<std::mutex> lock(change_lock);
+	for (auto& clog : changelog) {
+		if ( clog->generation <= after || clog->generation > upto ) continue;
+		auto it = clog->changes.find(f);
+		if ( it != clog->changes.end() ) {
+			if ( it->second.overflow ) return false;
+			idterms.insert(idterms.end(), it->second.idterms.begin(), it->second.idterms.end() );
+		}
+		++found;
 	}
+	return ( found == (upto - after) );
 }
 
 /**
-* Get: get the storage instance
+* AddChanged: record a changed idterm
 *
 */
-zpds::search::WriteIndex::DatabaseT& zpds::search::WriteIndex::Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
+void zpds::search::WriteIndex::AddChanged(ShardT& shard, const std::string& idterm)
+{
+	if (shard.overflow) return;
+	if (shard.changed.size() >= XAP_CHANGE_MAX_TERMS) {
+		shard.changed.clear();
+		shard.overflow = true;
+		return;
+	}
+	shard.changed.push_back(idterm);
+}
+
+/**
+* GetPendingDocs , GetPendingBytes , GetPendingSince : uncommitted changes
+*
+*/
+uint64_t zpds::search::WriteIndex::GetPendingDocs() const
+{
+	return pending_docs.load();
+}
+
+uint64_t zpds::search::WriteIndex::GetPendingBytes() const
+{
+	return pending_bytes.load();
+}
+
+uint64_t zpds::search::WriteIndex::GetPendingSince() const
+{
+	return pending_since.load();
+}
+
+/**
+* GetShardCount : number of shards per index
+*
+*/
+size_t zpds::search::WriteIndex::GetShardCount() const
+{
+	return shards;
+}
+
+/**
+* ShardPath : path of one shard
+*
+*/
+std::string zpds::search::WriteIndex::ShardPath(const std::string& dbpath,
+        ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, size_t shard)
 {
 	const google::protobuf::EnumDescriptor *l = zpds::search::LangTypeE_descriptor();
 	const google::protobuf::EnumDescriptor *d = zpds::search::IndexTypeE_descriptor();
-	int f = (ltyp * 1000) + dtyp;
-	if ( triemap.find(f) == triemap.end() ) {
-		const std::string xapath{dbpath + "/" + l->FindValueByNumber(ltyp)->name() + "_" + d->FindValueByNumber(dtyp)->name()};
-		if (!boost::filesystem::exists(xapath)) boost::filesystem::create_directories(xapath);
-		triemap[f] = DatabaseT(xapath, Xapian::DB_CREATE_OR_OPEN );
+	std::string xapath{dbpath + "/" + l->FindValueByNumber(ltyp)->name() + "_" + d->FindValueByNumber(dtyp)->name()};
+	if (shard>0) xapath += "_" + std::to_string(shard);
+	return xapath;
+}
+
+/**
+* ShardNo : shard for an idterm , fnv-1a so the layout does not depend on std::hash
+*
+*/
+size_t zpds::search::WriteIndex::ShardNo(const std::string& idterm, size_t shards)
+{
+	if (shards<2) return 0;
+	uint64_t h = 14695981039346656037ULL;
+	for (auto c : idterm) {
+		h ^= static_cast<unsigned char>(c);
+		h *= 1099511628211ULL;
+	}
+	return h % shards;
+}
+
+/**
+* CheckShards: check shard count against the one stored with the index
+*
+*/
+void zpds::search::WriteIndex::CheckShards()
+{
+	if (!boost::filesystem::exists(dbpath)) boost::filesystem::create_directories(dbpath);
+	const std::string sfile = dbpath + "/" + XAP_SHARDS_FILE;
+	size_t stored = 0;
+	{
+		std::ifstream in(sfile.c_str());
+		if (in.is_open()) in >> stored;
 	}
-	return triemap.at(f);
+	// old unsharded index without the file
+	if (stored==0 && shards==1) stored = 1;
+	if (stored==0) {
+		std::ofstream out(sfile.c_str(), std::ios::trunc);
+		out << shards;
+		if (!out) throw zpds::InitialException("cannot write " + sfile);
+		return;
+	}
+	if (stored != shards)
+		throw zpds::InitialException("xapian index has " + std::to_string(stored) + " shards, reindex to change shards");
+}
+
+/**
+* AddPending: account one uncommitted change
+*
+*/
+void zpds::search::WriteIndex::AddPending(uint64_t bytes)
+{
+	if (pending_docs.fetch_add(1)==0) pending_since.store(ZPDS_CURRTIME_MS);
+	pending_bytes.fetch_add(bytes);
 }
 
 /**
@@ -103,10 +288,17 @@ void zpds::search::WriteIndex::Update(
     ::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
     const std::string& idterm, ::Xapian::Document&& doc)
 {
-	std::lock_guard<std::mutex> lock(update_lock);
 	DLOG(INFO) << idterm ;
-	DLOG(INFO) << doc.serialise() ;
-	Get(ltyp, dtyp).replace_document(idterm, doc);
+	uint64_t bytes = idterm.length() + doc.get_data().length();
+	for (auto it = doc.termlist_begin() ; it != doc.termlist_end() ; ++it)
+		bytes += (*it).length() + XAP_PENDING_TERM_OVERHEAD;
+	ShardT& shard = Get(ltyp, dtyp, idterm);
+	{
+		std::lock_guard<std::mutex> lock(shard.lock);
+		shard.db.replace_document(idterm, doc);
+		AddChanged(shard, idterm);
+	}
+	AddPending(bytes);
 }
 
 /**
@@ -115,7 +307,12 @@ void zpds::search::WriteIndex::Update(
 */
 void zpds::search::WriteIndex::Delete(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp, const std::string& idterm)
 {
-	std::lock_guard<std::mutex> lock(update_lock);
 	DLOG(INFO) << idterm ;
-	Get(ltyp, dtyp).delete_document(idterm);
+	ShardT& shard = Get(ltyp, dtyp, idterm);
+	{
+		std::lock_guard<std::mutex> lock(shard.lock);
+		shard.db.delete_document(idterm);
+		AddChanged(shard, idterm);
+	}
+	AddPending(idterm.length());
 }
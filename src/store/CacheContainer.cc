@@ -33,10 +33,17 @@
 #include "store/CacheContainer.hpp"
 
 /**
-* Constructor : default private
+* Constructor : private
 *
 */
-zpds::store::CacheContainer::CacheContainer () {}
+zpds::store::CacheContainer::CacheContainer (size_t max_bytes, size_t shards)
+	: shard_bytes( max_bytes / ((shards>0) ? shards : 1) )
+{
+	if (max_bytes>0 && shard_bytes==0)
+		throw zpds::InitialException("cache memory too small for the shards");
+	for (size_t i=0 ; i < ((shards>0) ? shards : 1) ; ++i)
+		shards_.emplace_back( new ShardT() );
+}
 
 /**
 * destructor
@@ -44,55 +51,90 @@ zpds::store::CacheContainer::CacheContainer () {}
 zpds::store::CacheContainer::~CacheContainer () {}
 
 /**
-* SetAssoc : add an assoc entry
+* SetAssoc : add an assoc entry , least recent ones go if over the limit
 *
 */
-void zpds::store::CacheContainer::SetAssoc(std::string hash, zpds::store::CacheContainer::AssocT assoc, bool only_if_exists)
+void zpds::store::CacheContainer::SetAssoc(KeyT hash, zpds::store::CacheContainer::AssocT assoc, bool only_if_exists)
 {
-	WriteLockT writelock(mutex_);
+	ShardT& sh = GetShard(hash);
+	WriteLockT writelock(sh.mutex_);
 	DLOG(INFO) << "Added Assoc Cache: " << hash;
-	if (only_if_exists) {
-		if ( assoc_map.find(hash) == assoc_map.end() ) return;
+	auto it = sh.assoc_map.find(hash);
+	if (it == sh.assoc_map.end()) {
+		if (only_if_exists) return;
+		sh.lru.push_front( EntryT{ std::string(hash.data(), hash.size()), std::move(assoc) } );
+		size_t nbytes = EntryBytes(sh.lru.front());
+		if (shard_bytes>0 && nbytes > shard_bytes) {
+			sh.lru.pop_front();
+			return;
+		}
+		sh.assoc_map.emplace( KeyT(sh.lru.front().hash), sh.lru.begin() );
+		sh.bytes += nbytes;
+		++sh.entries;
+	}
+	else {
+		auto lt = it->second;
+		size_t obytes = EntryBytes(*lt);
+		size_t nbytes = obytes - lt->assoc.size() + assoc.size();
+		if (shard_bytes>0 && nbytes > shard_bytes) {
+			Erase(sh, lt);
+			return;
+		}
+		lt->assoc = std::move(assoc);
+		sh.bytes += nbytes;
+		sh.bytes -= obytes;
+		sh.lru.splice(sh.lru.begin(), sh.lru, lt);
+	}
+	while (shard_bytes>0 && sh.bytes.load() > shard_bytes && sh.lru.size()>1) {
+		Erase(sh, std::prev(sh.lru.end()));
+		++sh.evictions;
 	}
-	assoc_map[hash] = assoc;
 }
 
 /**
 * GetAssoc : get assoc
 *
 */
-bool zpds::store::CacheContainer::GetAssoc(std::string hash, zpds::store::CacheContainer::AssocT& assoc)
+bool zpds::store::CacheContainer::GetAssoc(KeyT hash, zpds::store::CacheContainer::AssocT& assoc)
 {
-	ReadLockT readlock(mutex_);
-	auto it = assoc_map.find(hash);
-	if (it != assoc_map.end()) {
-		assoc = it->second;
-		return true;
+	ShardT& sh = GetShard(hash);
+	WriteLockT writelock(sh.mutex_);
+	auto it = sh.assoc_map.find(hash);
+	if (it == sh.assoc_map.end()) {
+		++sh.misses;
+		return false;
 	}
-	return false;
+	auto lt = it->second;
+	if (lt != sh.lru.begin())
+		sh.lru.splice(sh.lru.begin(), sh.lru, lt);
+	assoc = lt->assoc;
+	++sh.hits;
+	return true;
 }
 
 /**
 * DelAssoc : del assoc entry
 *
 */
-void zpds::store::CacheContainer::DelAssoc(std::string hash)
+void zpds::store::CacheContainer::DelAssoc(KeyT hash)
 {
-	WriteLockT writelock(mutex_);
+	ShardT& sh = GetShard(hash);
+	WriteLockT writelock(sh.mutex_);
 	DLOG(INFO) << "Delete Assoc Cache: " << hash;
-	auto it = assoc_map.find(hash);
-	if (it != assoc_map.end())
-		assoc_map.erase(it);
+	auto it = sh.assoc_map.find(hash);
+	if (it != sh.assoc_map.end())
+		Erase(sh, it->second);
 }
 
 /**
 * CheckAssoc : get if assoc
 *
 */
-bool zpds::store::CacheContainer::CheckAssoc(std::string hash)
+bool zpds::store::CacheContainer::CheckAssoc(KeyT hash)
 {
-	ReadLockT readlock(mutex_);
-	return (assoc_map.find(hash) != assoc_map.end());
+	ShardT& sh = GetShard(hash);
+	WriteLockT writelock(sh.mutex_);
+	return (sh.assoc_map.find(hash) != sh.assoc_map.end());
 }
 
 /**
@@ -101,6 +143,86 @@ bool zpds::store::CacheContainer::CheckAssoc(std::string hash)
 */
 size_t zpds::store::CacheContainer::AssocSize()
 {
-	ReadLockT readlock(mutex_);
-	return assoc_map.size();
+	size_t count=0;
+	for (auto& sh : shards_) count += sh->entries.load();
+	return count;
+}
+
+/**
+* GetShards : no of shards
+*
+*/
+size_t zpds::store::CacheContainer::GetShards() const
+{
+	return shards_.size();
+}
+
+/**
+* GetHits , GetMisses , GetEvictions , GetBytes , GetEntries : counters of a shard
+*
+*/
+uint64_t zpds::store::CacheContainer::GetHits(size_t shard) const
+{
+	return GetShard(shard).hits.load();
+}
+
+uint64_t zpds::store::CacheContainer::GetMisses(size_t shard) const
+{
+	return GetShard(shard).misses.load();
+}
+
+uint64_t zpds::store::CacheContainer::GetEvictions(size_t shard) const
+{
+	return GetShard(shard).evictions.load();
+}
+
+uint64_t zpds::store::CacheContainer::GetBytes(size_t shard) const
+{
+	return GetShard(shard).bytes.load();
+}
+
+uint64_t zpds::store::CacheContainer::GetEntries(size_t shard) const
+{
+	return GetShard(shard).entries.load();
+}
+
+/**
+* GetShard : shard of a hash , high bits so the map buckets inside stay spread
+*
+*/
+zpds::store::CacheContainer::ShardT& zpds::store::CacheContainer::GetShard(KeyT hash)
+{
+	size_t h = KeyHashT()(hash);
+	return *shards_[ (h ^ (h >> 17)) % shards_.size() ];
+}
+
+/**
+* GetShard : shard by no
+*
+*/
+const zpds::store::CacheContainer::ShardT& zpds::store::CacheContainer::GetShard(size_t shard) const
+{
+	if (shard >= shards_.size()) throw zpds::BadCodeException("cache shard out of range");
+	return *shards_[shard];
+}
+
+/**
+* Erase : remove an entry , lock held
+*
+*/
+void zpds::store::CacheContainer::Erase(ShardT& sh, LruListT::iterator it)
+{
+	sh.bytes -= EntryBytes(*it);
+	--sh.entries;
+	sh.assoc_map.erase( KeyT(it->hash) );
+	sh.lru.erase(it);
+}
+
+/**
+* EntryBytes : approx memory of an entry
+*
+*/
+size_t zpds::store::CacheContainer::EntryBytes(const EntryT& entry)
+{
+	return entry.hash.size() + entry.assoc.size() + ZPDS_CACHE_ENTRY_OVERHEAD;
 }
@@ -82,6 +82,16 @@ bool zpds::store::CredServiceBase::CheckSession(::zpds::utils::SharedTable::poin
 
 	std::string sessionkey = data->sessionkey(); // dont swap here
 
+	// already checked and not changed since , the record kept has the categories so
+	// ValidateUserCategories works on a hit without going through Get
+	std::string cachekey;
+	uint64_t generation=0;
+	if (stptr->sesscache) {
+		cachekey = GetCacheKey( data->name() );
+		if (stptr->sesscache->Get(cachekey, sessionkey, ZPDS_CURRTIME_MS, data)) return true;
+		generation = stptr->sesscache->GetGeneration(cachekey);
+	}
+
 	Get(stptr,data); // inherited function gets
 	if (data->notfound())
 		throw zpds::BadDataException("No such user or Invalid session",M_INVALID_PARAM);
@@ -107,6 +117,9 @@ bool zpds::store::CredServiceBase::CheckSession(::zpds::utils::SharedTable::poin
 	if ( currtime - xuser.updated_at() > ZPDS_SESSION_LIFETIME_MS )
 		throw zpds::BadDataException("Session Key has Expired",M_INVALID_PARAM);
 
+	if (stptr->sesscache)
+		stptr->sesscache->Set(cachekey, sessionkey, xuser.updated_at() + ZPDS_SESSION_LIFETIME_MS, generation, data);
+
 	return true;
 
 }
@@ -42,7 +42,7 @@
 void zpds::store::ExterCredService::Get(::zpds::utils::SharedTable::pointer stptr, ::zpds::store::ExterDataT* data) const
 {
 	std::string temp;
-	bool user_found= stptr->dbcache->GetAssoc( EncodeSecondaryKey<std::string>(U_EXTERDATA_NAME, data->name() ), temp);
+	bool user_found= stptr->dbcache->GetAssoc( GetCacheKey( data->name() ), temp);
 	if (user_found) {
 		user_found = data->ParseFromString(temp);
 	}
@@ -50,7 +50,7 @@ void zpds::store::ExterCredService::Get(::zpds::utils::SharedTable::pointer stpt
 		::zpds::store::ExterDataTable user_table{stptr->maindb.Get()};
 		user_found = user_table.GetOne(data,::zpds::store::U_EXTERDATA_NAME);
 		if (user_found) {
-			stptr->dbcache->SetAssoc( EncodeSecondaryKey<std::string>(U_EXTERDATA_NAME, data->name() ), Pack(data) );
+			stptr->dbcache->SetAssoc( GetCacheKey( data->name() ), Pack(data) );
 			DLOG(INFO) << "Set Cache Exter " << data->name();
 		}
 	}
@@ -58,6 +58,15 @@ void zpds::store::ExterCredService::Get(::zpds::utils::SharedTable::pointer stpt
 	else data->set_keytype(::zpds::store::K_EXTERDATA);
 }
 
+/**
+* GetCacheKey : key of the user in dbcache and sesscache
+*
+*/
+std::string zpds::store::ExterCredService::GetCacheKey(const std::string& name) const
+{
+	return EncodeSecondaryKey<std::string>(U_EXTERDATA_NAME, name);
+}
+
 /**
 * Pack : shrink to bare essentials for packing into cache
 *
@@ -182,6 +182,12 @@ void zpds::store::ItemDataService::ManageDataAction(::zpds::utils::SharedTable::
 			throw ::zpds::BadDataException("Cannot Insert item data");
 	}
 
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+	// backpressure , wait for pending index changes to be committed
+	if ( stptr->xapcommit && !stptr->no_xapian.Get() && !stptr->xapcommit->WaitForRoom() )
+		throw zpds::BadDataException("Search index is busy, retry later",M_BAD_BACKEND);
+#endif
+
 	// commit to table
 	zpds::store::StoreTrans storetrans(currtime);
 	trans.set_updater( updater.name() );
@@ -217,11 +223,18 @@ void zpds::store::ItemDataService::ReadDataAction(
 		status->set_inputcount( status->inputcount() + ( rdata->notfound() ? 0 : 1 ) );
 	}
 
-	// update payloads if exists
+	// update payloads if exists , records read together
+	::google::protobuf::RepeatedPtrField< ::zpds::store::ItemDataT > fetched;
 	for (auto i = 0 ; i<resp->payloads_size(); ++i)	{
+		if (resp->payloads(i).unique_id().empty()) continue;
+		fetched.Add()->set_unique_id( resp->payloads(i).unique_id() );
+	}
+	if (fetched.size()>0) GetManyRecords(stptr, &fetched);
+
+	for (auto i = 0, j = 0 ; i<resp->payloads_size(); ++i)	{
 		if (resp->payloads(i).unique_id().empty()) continue;
 		auto rdata = resp->mutable_payloads(i);
-		ReadData(stptr,&reader,rdata,fields);
+		ReadData(stptr,&reader,rdata,fields,fetched.Mutable(j++));
 		status->set_inputcount( status->inputcount() + ( rdata->notfound() ? 0 : 1 ) );
 	}
 
@@ -436,6 +449,11 @@ bool zpds::store::ItemDataService::PrepareData(
 	// Modify: geometry
 	if ( (fields & ZPDS_IDFLD_GEOMETRY) && ( perms & ( ZPDS_WRTPID_GEOMETRY ) ) ) {
 		LOCAL_HANDLE_STRING(geometry);
+		// parsed once here , searches only copy it
+		std::vector<double> extent;
+		::zpds::utils::SplitWith::Box( cdata.geometry(), extent );
+		cdata.clear_extent();
+		for (auto& d : extent) cdata.add_extent(d);
 	}
 
 	// Modify: local fields
@@ -495,7 +513,7 @@ bool zpds::store::ItemDataService::PrepareData(
 void zpds::store::ItemDataService::ReadData(
     ::zpds::utils::SharedTable::pointer stptr,
     ::zpds::store::UserDataT* reader,
-    ::zpds::store::ItemDataT* data, int32_t fields)
+    ::zpds::store::ItemDataT* data, int32_t fields, ::zpds::store::ItemDataT* fetched)
 {
 
 	// if unique_id present
@@ -503,8 +521,15 @@ void zpds::store::ItemDataService::ReadData(
 		throw ::zpds::BadDataException("unique_id is needed",M_INVALID_PARAM);
 
 	::zpds::store::ItemDataT cdata;
-	cdata.set_unique_id( data->unique_id() );
-	bool item_found = GetOneRecord( stptr, &cdata );
+	bool item_found = false;
+	if (fetched) {
+		cdata.Swap(fetched);
+		item_found = !cdata.notfound();
+	}
+	else {
+		cdata.set_unique_id( data->unique_id() );
+		item_found = GetOneRecord( stptr, &cdata );
+	}
 
 	if (!item_found) {
 		data->set_notfound(true);
@@ -594,7 +619,8 @@ void zpds::store::ItemDataService::ReadData(
 		data->set_rating( cdata.rating() );
 	}
 
-	// Read: geometry
+	// Read: geometry , extent is kept for search projections only and not returned
+	data->clear_extent();
 	if ( (fields & ZPDS_IDFLD_GEOMETRY) && ( perms & ( ZPDS_READID_GEOMETRY ))) {
 		data->set_geometry( cdata.geometry() );
 	}
@@ -0,0 +1,176 @@
+/**
+ * @project zapdos
+ * @file src/store/SessionCache.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  SessionCache.cc : Verified session keys with their user record impl
+ *
+ */
+#include "store/SessionCache.hpp"
+#include <functional>
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::store::SessionCache::SessionCache(size_t max_users_, size_t per_user_)
+	: shard_users( (max_users_ + ZPDS_SESSION_CACHE_SHARDS - 1) / ZPDS_SESSION_CACHE_SHARDS ),
+	  per_user( (per_user_>0) ? per_user_ : ZPDS_SESSION_CACHE_PER_USER ),
+	  hits(0), misses(0), count(0)
+{
+	if (shard_users==0) throw zpds::InitialException("session cache needs at least one user");
+}
+
+/**
+ * Destructor : default
+ *
+ */
+zpds::store::SessionCache::~SessionCache() {}
+
+/**
+* Get : record of a checked session key not yet expired
+*
+*/
+bool zpds::store::SessionCache::Get(const std::string& key, const std::string& sessionkey, uint64_t currtime, ::zpds::store::UserDataT* data)
+{
+	RecordT record;
+	{
+		ShardT& sh = GetShard(key);
+		std::lock_guard<std::mutex> lock(sh.lock);
+		auto it = sh.entries.find(key);
+		if (it != sh.entries.end()) {
+			auto lt = it->second;
+			for (auto& s : lt->sessions) {
+				if (s.sessionkey != sessionkey) continue;
+				if (currtime <= s.expires_at) record = lt->record;
+				break;
+			}
+			if (record) sh.lru.splice(sh.lru.begin(), sh.lru, lt);
+		}
+	}
+	if (!record) {
+		++misses;
+		return false;
+	}
+	++hits;
+	data->CopyFrom(*record);
+	return true;
+}
+
+/**
+* GetGeneration : take before reading the record
+*
+*/
+uint64_t zpds::store::SessionCache::GetGeneration(const std::string& key)
+{
+	ShardT& sh = GetShard(key);
+	std::lock_guard<std::mutex> lock(sh.lock);
+	return sh.generation;
+}
+
+/**
+* Set : keep a checked session key
+*
+*/
+void zpds::store::SessionCache::Set(const std::string& key, const std::string& sessionkey, uint64_t expires_at,
+                                    uint64_t generation, const ::zpds::store::UserDataT* data)
+{
+	RecordT record = std::make_shared<const ::zpds::store::UserDataT>(*data);
+	ShardT& sh = GetShard(key);
+	std::lock_guard<std::mutex> lock(sh.lock);
+	// the user changed after the record was read
+	if (generation != sh.generation) return;
+
+	auto it = sh.entries.find(key);
+	if (it == sh.entries.end()) {
+		sh.lru.push_front( EntryT{ key, record, {} } );
+		it = sh.entries.emplace( key, sh.lru.begin() ).first;
+		++count;
+		while (sh.lru.size() > shard_users) {
+			sh.entries.erase( sh.lru.back().key );
+			sh.lru.pop_back();
+			--count;
+		}
+	}
+	else {
+		sh.lru.splice(sh.lru.begin(), sh.lru, it->second);
+	}
+
+	EntryT& entry = *it->second;
+	entry.record = record;
+	for (auto st = entry.sessions.begin() ; st != entry.sessions.end() ; ++st) {
+		if (st->sessionkey != sessionkey) continue;
+		entry.sessions.erase(st);
+		break;
+	}
+	if (entry.sessions.size() >= per_user) entry.sessions.erase( entry.sessions.begin() );
+	entry.sessions.push_back( SessionT{ sessionkey, expires_at } );
+}
+
+/**
+* Del : drop a user with all session keys
+*
+*/
+void zpds::store::SessionCache::Del(const std::string& key)
+{
+	ShardT& sh = GetShard(key);
+	std::lock_guard<std::mutex> lock(sh.lock);
+	++sh.generation;
+	auto it = sh.entries.find(key);
+	if (it == sh.entries.end()) return;
+	sh.lru.erase(it->second);
+	sh.entries.erase(it);
+	--count;
+}
+
+/**
+* GetHits , GetMisses , GetEntries : counters
+*
+*/
+uint64_t zpds::store::SessionCache::GetHits() const
+{
+	return hits.load();
+}
+
+uint64_t zpds::store::SessionCache::GetMisses() const
+{
+	return misses.load();
+}
+
+uint64_t zpds::store::SessionCache::GetEntries() const
+{
+	return count.load();
+}
+
+/**
+* GetShard : shard of a key
+*
+*/
+zpds::store::SessionCache::ShardT& zpds::store::SessionCache::GetShard(const std::string& key)
+{
+	return shards[ std::hash<std::string>()(key) % ZPDS_SESSION_CACHE_SHARDS ];
+}
@@ -37,6 +37,8 @@
 #define ZPDS_ROCKSDB_TBL_BLOCKSIZE 4 * 1024 // ssd disk based
 
 #include "store/StoreLevel.hpp"
+#include <algorithm>
+#include <numeric>
 
 #ifdef ZPDS_BUILD_WITH_LEVELDB
 #include <leveldb/filter_policy.h>
@@ -157,3 +159,44 @@ zpds::store::StoreLevel::dbpointer zpds::store::StoreLevel::getDB()
 {
 	return this->db;
 }
+
+/**
+* MultiRead: read many keys in one call
+*
+*/
+std::vector<bool> zpds::store::StoreLevel::MultiRead(const std::vector<std::string>& keys, std::vector<std::string>& values)
+{
+	std::vector<bool> found( keys.size(), false );
+	values.assign( keys.size(), std::string() );
+	if (keys.empty()) return found;
+
+	// sorted keys read neighbouring blocks together
+	std::vector<size_t> order( keys.size() );
+	std::iota( order.begin(), order.end(), 0 );
+	std::sort( order.begin(), order.end(), [&keys](size_t a, size_t b) {
+		return keys[a] < keys[b];
+	});
+
+#ifdef ZPDS_BUILD_WITH_LEVELDB
+	// no multiget , read each from one snapshot
+	usemydb::ReadOptions options;
+	options.snapshot = getDB()->GetSnapshot();
+	for (auto o : order) {
+		usemydb::Status s = getDB()->Get(options, keys[o], &values[o]);
+		found[o] = s.ok();
+	}
+	getDB()->ReleaseSnapshot(options.snapshot);
+#elif ZPDS_BUILD_WITH_ROCKSDB
+	std::vector<usemydb::Slice> slices;
+	slices.reserve( keys.size() );
+	for (auto o : order) slices.emplace_back( keys[o] );
+	std::vector<std::string> svalues;
+	std::vector<usemydb::Status> status = getDB()->MultiGet(usemydb::ReadOptions(), slices, &svalues);
+	for (size_t j=0 ; j < order.size() ; ++j) {
+		if (!status[j].ok()) continue;
+		found[ order[j] ] = true;
+		values[ order[j] ].swap( svalues[j] );
+	}
+#endif
+	return found;
+}
@@ -69,17 +69,32 @@ void zpds::store::StoreTrans::StoreTrans::Commit(::zpds::utils::SharedTable::poi
 	}
 
 	if (trans->item_size()==0) return;
-	if (!CommitLog(stptr,trans,is_master))
+	if (!CommitLog(stptr,trans,is_master)) {
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+		// the log id is used up , tell the index pipeline not to wait for it
+		if (stptr->xapindexer) stptr->xapindexer->Skip(trans->id());
+#endif
 		throw ::zpds::BadDataException("Insert failed for log");
-	if (!CommitData(stptr,trans))
-		throw ::zpds::BadDataException("Insert failed for data");
-	// replicate this data on lastslave
-	auto lastslave = stptr->lastslave.Get();
-	if (is_master && stptr->is_master.Get() && (lastslave.length()>0)) {
-		zpds::hrpc::HrpcClient hclient;
-		bool status = hclient.SendToRemote(stptr,lastslave,::zpds::hrpc::R_BUFFTRANS,trans,true);
-		if (!status) stptr->lastslave.Set("");
 	}
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+	try {
+#endif
+		if (!CommitData(stptr,trans))
+			throw ::zpds::BadDataException("Insert failed for data");
+		// replicate this data on lastslave
+		auto lastslave = stptr->lastslave.Get();
+		if (is_master && stptr->is_master.Get() && (lastslave.length()>0)) {
+			zpds::hrpc::HrpcClient hclient;
+			bool status = hclient.SendToRemote(stptr,lastslave,::zpds::hrpc::R_BUFFTRANS,trans,true);
+			if (!status) stptr->lastslave.Set("");
+		}
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+	}
+	catch (...) {
+		if (stptr->xapindexer) stptr->xapindexer->Skip(trans->id());
+		throw;
+	}
+#endif
 	// add to cache
 	AddToCache(stptr,trans);
 
@@ -196,6 +211,12 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 	if (trans->item_size()==0) return;
 	// bool only_if_exists=true;
 
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+	// index items for the pipeline , pushed even if empty so the log id watermark moves
+	::zpds::store::TransactionT itrans;
+	itrans.set_id( trans->id() );
+#endif
+
 	for (auto i=0; i<trans->item_size(); ++i) {
 		std::string key = trans->mutable_item(i)->key();
 		bool to_del = trans->mutable_item(i)->to_del() ;
@@ -228,6 +249,7 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 			// delete from cache
 			std::string&& name = EncodeSecondaryKey<std::string>(U_EXTERDATA_NAME, record.name());
 			stptr->dbcache->DelAssoc( name );
+			if (stptr->sesscache) stptr->sesscache->Del( name );
 			break;
 		}
 
@@ -237,6 +259,7 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 			// delete from cache
 			std::string&& name = EncodeSecondaryKey<std::string>(U_USERDATA_NAME, record.name());
 			stptr->dbcache->DelAssoc( name );
+			if (stptr->sesscache) stptr->sesscache->Del( name );
 			break;
 		}
 
@@ -244,6 +267,13 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 			// as of now this needs only xapian , if there are more place this line inside ZPDS_BUILD_WITH_XAPIAN
 			if ( stptr->no_xapian.Get() ) continue;
 
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+			// built and written by the index pipeline in log order
+			if (stptr->xapindexer) {
+				itrans.add_item()->CopyFrom( trans->item(i) );
+				break;
+			}
+#endif
 			::zpds::store::ItemDataT record;
 			if (!record.ParseFromString(trans->mutable_item(i)->value())) continue;
 #ifdef ZPDS_BUILD_WITH_XAPIAN
@@ -258,6 +288,13 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 			// as of now this needs only xapian , if there are more place this line inside ZPDS_BUILD_WITH_XAPIAN
 			if ( stptr->no_xapian.Get() ) continue;
 
+#ifdef ZPDS_BUILD_WITH_XAPIAN
+			// built and written by the index pipeline in log order
+			if (stptr->xapindexer) {
+				itrans.add_item()->CopyFrom( trans->item(i) );
+				break;
+			}
+#endif
 			::zpds::store::ItemDataT record;
 			if (!record.ParseFromString(trans->mutable_item(i)->value())) continue;
 #ifdef ZPDS_BUILD_WITH_XAPIAN
@@ -273,9 +310,31 @@ void zpds::store::StoreTrans::AddToCache(::zpds::utils::SharedTable::pointer stp
 		}
 	}
 #ifdef ZPDS_BUILD_WITH_XAPIAN
+	// Push moves itrans only if accepted , if the pipeline is stopped index here
+	uint64_t logid = itrans.id();
+	bool pushed = (stptr->xapindexer && stptr->xapindexer->Push( std::move(itrans) ) );
+	if (stptr->xapindexer && !pushed) {
+		for (auto i=0; i<itrans.item_size(); ++i) {
+			std::string key = itrans.mutable_item(i)->key();
+			::zpds::store::ItemDataT record;
+			if (!record.ParseFromString(itrans.mutable_item(i)->value())) continue;
+			const ::zpds::search::IndexBase& index = ( DecodePrimaryKey(key).first == K_WIKIDATA )
+			        ? static_cast<const ::zpds::search::IndexBase&>(indexwiki)
+			        : static_cast<const ::zpds::search::IndexBase&>(indexlocal);
+			if ( itrans.mutable_item(i)->to_del() ) index.DelRecord(stptr, &record);
+			else index.AddRecord(stptr, &record);
+		}
+	}
+
 	if (stptr->force_commit.Get()) {
 		stptr->force_commit.Set(false);
-		stptr->xapdb->CommitData();
+		// commit only after the pipeline has written this transaction
+		if (pushed) stptr->xapindexer->CommitAfter(logid);
+		else if (stptr->xapcommit) stptr->xapcommit->RequestCommit();
+		else stptr->xapdb->CommitData();
+	}
+	else if (stptr->xapcommit) {
+		stptr->xapcommit->Notify();
 	}
 #endif
 }
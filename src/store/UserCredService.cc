@@ -42,7 +42,7 @@
 void zpds::store::UserCredService::Get(::zpds::utils::SharedTable::pointer stptr, ::zpds::store::UserDataT* data) const
 {
 	std::string temp;
-	bool user_found= stptr->dbcache->GetAssoc( EncodeSecondaryKey<std::string>(U_USERDATA_NAME, data->name() ), temp);
+	bool user_found= stptr->dbcache->GetAssoc( GetCacheKey( data->name() ), temp);
 	if (user_found) {
 		user_found = data->ParseFromString(temp);
 	}
@@ -50,7 +50,7 @@ void zpds::store::UserCredService::Get(::zpds::utils::SharedTable::pointer stptr
 		::zpds::store::UserDataTable user_table{stptr->maindb.Get()};
 		user_found = user_table.GetOne(data,::zpds::store::U_USERDATA_NAME);
 		if (user_found) {
-			stptr->dbcache->SetAssoc( EncodeSecondaryKey<std::string>(U_USERDATA_NAME, data->name() ), Pack(data) );
+			stptr->dbcache->SetAssoc( GetCacheKey( data->name() ), Pack(data) );
 			DLOG(INFO) << "Set Cache User " << data->name();
 			// add all user categories to cache with ts
 			for (auto i = 0; i < data->categories_size(); ++i) {
@@ -65,6 +65,15 @@ void zpds::store::UserCredService::Get(::zpds::utils::SharedTable::pointer stptr
 }
 
 
+/**
+* GetCacheKey : key of the user in dbcache and sesscache
+*
+*/
+std::string zpds::store::UserCredService::GetCacheKey(const std::string& name) const
+{
+	return EncodeSecondaryKey<std::string>(U_USERDATA_NAME, name);
+}
+
 /**
 * Pack : shrink to bare essentials for packing into cache, dont alter data
 *
@@ -117,6 +126,17 @@ bool zpds::store::UserCredService::ValidateUserCategories(::zpds::utils::SharedT
 		                     updated_at);
 		if (cat_found && updated_at==to_compare)  return true;
 	}
+	// category entries can be evicted while the user stays cached , the user record
+	// has its categories , check there and put the entries back
+	for (auto i=0; i<categories->size(); ++i) {
+		for (auto j=0; j<data->categories_size(); ++j) {
+			if (data->categories(j) != categories->Get(i)) continue;
+			stptr->dbcache->SetAssoc(
+			    EncodeSecondaryKey<std::string,std::string>(F_USERDATA_NAME_CATEGORY, data->name(), categories->Get(i)),
+			    to_compare);
+			return true;
+		}
+	}
 	return false;
 }
 
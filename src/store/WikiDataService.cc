@@ -70,14 +70,17 @@ void zpds::store::WikiDataService::GetManyRecords (
     ::google::protobuf::RepeatedPtrField< ::zpds::store::ItemDataT >* data) const
 {
 	::zpds::store::WikiDataTable vdo_table{stptr->maindb.Get()};
+	std::vector<::zpds::store::KeyTypeE> keytypes;
+	keytypes.reserve( data->size() );
 	for (auto i=0 ; i< data->size(); ++i) {
-		bool status=false;
-		if (! data->Mutable(i)->unique_id().empty())
-			status = vdo_table.GetOne(data->Mutable(i),::zpds::store::U_WIKIDATA_UNIQUEID);
-		else if (data->Mutable(i)->id() >0)
-			status = vdo_table.GetOne(data->Mutable(i),::zpds::store::K_WIKIDATA);
-		if (!status) data->Mutable(i)->set_notfound(true);
+		if (! data->Get(i).unique_id().empty())
+			keytypes.push_back( ::zpds::store::U_WIKIDATA_UNIQUEID );
+		else if (data->Get(i).id() >0)
+			keytypes.push_back( ::zpds::store::K_WIKIDATA );
+		else
+			keytypes.push_back( ::zpds::store::NOKEY );
 	}
+	vdo_table.GetBatch(data, keytypes);
 }
 
 /**
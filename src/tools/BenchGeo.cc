@@ -0,0 +1,157 @@
+/**
+ * @project zapdos
+ * @file src/tools/BenchGeo.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  BenchGeo.cc : zpds_benchgeo : Distance slab scoring benchmark
+ *
+ */
+#define STRIP_FLAG_HELP 1
+#define STRIP_INTERNAL_FLAG_HELP 1
+#include <gflags/gflags.h>
+
+/* GFlags Start */
+DEFINE_bool(h, false, "Show help");
+DECLARE_bool(help);
+DECLARE_bool(helpshort);
+
+DEFINE_uint64(points, 1000000, "No of points to score");
+DEFINE_int32(rounds, 5, "No of rounds , best is shown");
+DEFINE_int32(slab, 1000, "Distance band in meters");
+DEFINE_double(spread, 2.0, "Spread of points around centre in degrees");
+DEFINE_double(lat, 12.97, "Latitude of centre");
+DEFINE_double(lon, 77.59, "Longitude of centre");
+/* GFlags End */
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "search/DistanceSlabBatch.hpp"
+
+#define ZPDS_DEFAULT_EXE_NAME "zpds_benchgeo"
+#define ZPDS_DEFAULT_EXE_VERSION "1.0.0"
+#define ZPDS_DEFAULT_EXE_COPYRIGHT "Copyright (c) 2020 S Roychowdhury"
+
+using RowVecT = std::vector<::zpds::search::GeoColumn::RowT>;
+
+/**
+* TimeIt : best of rounds in ns per point
+*
+*/
+template <typename F>
+double TimeIt(F&& func, size_t points)
+{
+	double best = 0;
+	for (int r=0 ; r < FLAGS_rounds ; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto took = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		if (r==0 || took < best) best = took;
+	}
+	return best / points;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string usage("Usage:\n");
+	usage += std::string(argv[0]) + " -points 1000000 -slab 1000\n" ;
+	gflags::SetUsageMessage(usage);
+	gflags::SetVersionString(ZPDS_DEFAULT_EXE_VERSION);
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_h) {
+		FLAGS_help = false;
+		FLAGS_helpshort = true;
+	}
+	gflags::HandleCommandLineHelpFlags();
+
+	const size_t n = FLAGS_points;
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> dlat(FLAGS_lat - FLAGS_spread, FLAGS_lat + FLAGS_spread);
+	std::uniform_real_distribution<double> dlon(FLAGS_lon - FLAGS_spread, FLAGS_lon + FLAGS_spread);
+
+	// points as stored in the columns , through serialise like the index
+	RowVecT rows(n);
+	std::vector<double> sinlat(n), coslat(n), sinlon(n), coslon(n), hout(n);
+	for (size_t i=0 ; i<n ; ++i) {
+		Xapian::LatLongCoord c;
+		c.unserialise( Xapian::LatLongCoord( dlat(gen), dlon(gen) ).serialise() );
+		::zpds::search::GeoColumn::SetPoint(rows[i], c.latitude, c.longitude);
+		sinlat[i] = rows[i].sinlat;
+		coslat[i] = rows[i].coslat;
+		sinlon[i] = rows[i].sinlon;
+		coslon[i] = rows[i].coslon;
+	}
+
+	Xapian::LatLongCoord centre(FLAGS_lat, FLAGS_lon);
+	Xapian::LatLongCoords centres(centre);
+	const Xapian::GreatCircleMetric metric;
+	const int maxdist = XAP_DSLAB_MAX_DISTANCE;
+	if (!::zpds::search::DistanceSlabBatch::CanUse(FLAGS_slab, maxdist)) {
+		std::cerr << "slab too small for batch scoring" << std::endl;
+		return 1;
+	}
+
+	// current : metric per point as DistanceSlabKeyMaker
+	std::vector<int> exact(n);
+	double ns_metric = TimeIt( [&]() {
+		for (size_t i=0 ; i<n ; ++i) {
+			Xapian::LatLongCoords doccoords( Xapian::LatLongCoord(rows[i].lat, rows[i].lon) );
+			long d = std::lround( metric(centres, doccoords) );
+			exact[i] = 1 + ( std::min<long>( std::max<long>(d, 0), maxdist ) / FLAGS_slab );
+		}
+	}, n);
+	std::cout << std::setw(10) << "metric" << std::setw(12) << std::fixed << std::setprecision(2) << ns_metric << " ns/point" << std::endl;
+
+	const ::zpds::search::HaversineKernel::IsaE isas[] = {
+		::zpds::search::HaversineKernel::ISA_SCALAR,
+		::zpds::search::HaversineKernel::ISA_SSE4,
+		::zpds::search::HaversineKernel::ISA_AVX2
+	};
+	for (auto isa : isas) {
+		if (isa > ::zpds::search::HaversineKernel::BestIsa()) continue;
+		::zpds::search::HaversineKernel kernel(FLAGS_lat, FLAGS_lon, isa);
+		::zpds::search::DistanceSlabBatch batch(centre, FLAGS_slab, maxdist, maxdist, nullptr, 1);
+		std::vector<int> slabs(n);
+		double ns_kernel = TimeIt( [&]() {
+			for (size_t i=0 ; i<n ; i+=XAP_DSLAB_BATCH) {
+				size_t m = std::min<size_t>(XAP_DSLAB_BATCH, n-i);
+				kernel.Haversine(&sinlat[i], &coslat[i], &sinlon[i], &coslon[i], m, &hout[i]);
+				for (size_t k=i ; k<i+m ; ++k) slabs[k] = batch.Slab(hout[k], rows[k]);
+			}
+		}, n);
+		size_t mismatch = 0;
+		for (size_t i=0 ; i<n ; ++i) mismatch += (slabs[i]!=exact[i]);
+		std::cout << std::setw(10) << kernel.GetIsaName() << std::setw(12) << ns_kernel << " ns/point"
+		          << "  speedup " << ns_metric / ns_kernel
+		          << "  refined " << batch.GetRefined() / FLAGS_rounds
+		          << "  mismatch " << mismatch << std::endl;
+	}
+	return 0;
+}
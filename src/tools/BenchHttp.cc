@@ -0,0 +1,248 @@
+/**
+ * @project zapdos
+ * @file src/tools/BenchHttp.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  BenchHttp.cc : Load generator for the http server , persistent and pipelined
+ *
+ */
+#define STRIP_FLAG_HELP 1
+#define STRIP_INTERNAL_FLAG_HELP 1
+#include <gflags/gflags.h>
+
+/* GFlags Start */
+DEFINE_bool(h, false, "Show help");
+DECLARE_bool(help);
+DECLARE_bool(helpshort);
+
+DEFINE_string(host, "127.0.0.1", "Server host");
+DEFINE_string(port, "9091", "Server port");
+DEFINE_string(paths, "/status", "Request paths , comma separated , used in turn");
+DEFINE_uint64(connections, 1000, "No of concurrent connections");
+DEFINE_uint64(pipeline, 1, "Requests sent together on a connection before reading responses");
+DEFINE_uint64(seconds, 10, "Duration of run");
+DEFINE_uint64(threads, 1, "No of client threads");
+DEFINE_bool(gzip, false, "Send Accept-Encoding gzip");
+DEFINE_bool(keepalive, true, "Reuse connections , else one request per connection");
+/* GFlags End */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+
+#include "http/AsioCompat.hpp"
+
+#define ZPDS_DEFAULT_EXE_NAME "zpds_benchhttp"
+#define ZPDS_DEFAULT_EXE_VERSION "1.0.0"
+#define ZPDS_DEFAULT_EXE_COPYRIGHT "Copyright (c) 2020 S Roychowdhury"
+
+namespace asio = ::zpds::http::asio;
+using error_code = ::zpds::http::error_code;
+using ClockT = std::chrono::steady_clock;
+using LatVecT = std::vector<uint32_t>;
+
+std::vector<std::string> paths;
+std::atomic<bool> running(true);
+
+/**
+* ClientT : one connection sending batches of pipelined requests
+*
+*/
+struct ClientT : public std::enable_shared_from_this<ClientT> {
+	asio::ip::tcp::socket socket;
+	const asio::ip::tcp::resolver::results_type& endpoints;
+	LatVecT& latency;
+	uint64_t& errors;
+	uint64_t& bytes;
+	size_t next;
+	asio::streambuf inbuf;
+	std::string outbuf;
+	std::vector<ClockT::time_point> sent;
+	size_t pending = 0;
+
+	ClientT(asio::io_context& io, const asio::ip::tcp::resolver::results_type& endpoints_,
+	        LatVecT& latency_, uint64_t& errors_, uint64_t& bytes_, size_t next_)
+		: socket(io), endpoints(endpoints_), latency(latency_), errors(errors_), bytes(bytes_), next(next_) {}
+
+	void Connect()
+	{
+		auto self = shared_from_this();
+		asio::async_connect(socket, endpoints, [self](const error_code& ec, const asio::ip::tcp::endpoint&) {
+			if (ec) return self->Fail();
+			socket_no_delay(self->socket);
+			self->Send();
+		});
+	}
+
+	static void socket_no_delay(asio::ip::tcp::socket& s)
+	{
+		error_code ec;
+		s.set_option(asio::ip::tcp::no_delay(true), ec);
+	}
+
+	void Send()
+	{
+		if (!running) return;
+		outbuf.clear();
+		sent.clear();
+		const size_t batch = (FLAGS_keepalive) ? std::max<uint64_t>(FLAGS_pipeline, 1) : 1;
+		for (size_t i = 0 ; i < batch ; ++i) {
+			outbuf += "GET " + paths[next++ % paths.size()] + " HTTP/1.1\r\nHost: " + FLAGS_host + "\r\n";
+			if (FLAGS_gzip) outbuf += "Accept-Encoding: gzip\r\n";
+			if (!FLAGS_keepalive) outbuf += "Connection: close\r\n";
+			outbuf += "\r\n";
+		}
+		pending = batch;
+		auto now = ClockT::now();
+		sent.assign(batch, now);
+		auto self = shared_from_this();
+		asio::async_write(socket, asio::buffer(outbuf), [self](const error_code& ec, size_t) {
+			if (ec) return self->Fail();
+			self->ReadHeader();
+		});
+	}
+
+	void ReadHeader()
+	{
+		auto self = shared_from_this();
+		asio::async_read_until(socket, inbuf, "\r\n\r\n", [self](const error_code& ec, size_t header_len) {
+			if (ec) return self->Fail();
+			std::string header( asio::buffers_begin(self->inbuf.data()), asio::buffers_begin(self->inbuf.data()) + header_len );
+			self->inbuf.consume(header_len);
+			if (header.compare(0, 12, "HTTP/1.1 200") != 0 && header.compare(0, 12, "HTTP/1.0 200") != 0) ++self->errors;
+			size_t length = 0;
+			std::string lower = boost::algorithm::to_lower_copy(header);
+			auto pos = lower.find("content-length:");
+			if (pos != std::string::npos) length = std::strtoul(lower.c_str() + pos + 15, nullptr, 10);
+			self->bytes += header_len + length;
+			size_t have = self->inbuf.size();
+			if (have >= length) {
+				self->inbuf.consume(length);
+				return self->Done();
+			}
+			asio::async_read(self->socket, self->inbuf, asio::transfer_exactly(length - have), [self, length](const error_code& ec, size_t) {
+				if (ec) return self->Fail();
+				self->inbuf.consume(length);
+				self->Done();
+			});
+		});
+	}
+
+	void Done()
+	{
+		const size_t i = sent.size() - pending;
+		latency.push_back( std::chrono::duration_cast<std::chrono::microseconds>(ClockT::now() - sent[i]).count() );
+		if (--pending > 0) return ReadHeader();
+		if (FLAGS_keepalive) return Send();
+
+		// new connection per request
+		error_code ec;
+		socket.close(ec);
+		inbuf.consume(inbuf.size());
+		if (running) Connect();
+	}
+
+	void Fail()
+	{
+		if (!running) return;
+		++errors;
+		error_code ec;
+		socket.close(ec);
+		inbuf.consume(inbuf.size());
+		Connect();
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	std::string usage("Usage:\n");
+	usage += std::string(argv[0]) + " -port 9091 -paths /status -connections 1000 -seconds 10\n" ;
+	gflags::SetUsageMessage(usage);
+	gflags::SetVersionString(ZPDS_DEFAULT_EXE_VERSION);
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_h) {
+		FLAGS_help = false;
+		FLAGS_helpshort = true;
+	}
+	gflags::HandleCommandLineHelpFlags();
+
+	boost::algorithm::split(paths, FLAGS_paths, boost::algorithm::is_any_of(","));
+	const size_t nthreads = std::max<uint64_t>(FLAGS_threads, 1);
+
+	std::vector<std::unique_ptr<asio::io_context>> ios;
+	std::vector<LatVecT> latency(nthreads);
+	std::vector<uint64_t> errors(nthreads, 0);
+	std::vector<uint64_t> bytes(nthreads, 0);
+	std::vector<asio::ip::tcp::resolver::results_type> endpoints(nthreads);
+	for (size_t t = 0 ; t < nthreads ; ++t) {
+		ios.emplace_back(new asio::io_context());
+		asio::ip::tcp::resolver resolver(*ios[t]);
+		endpoints[t] = resolver.resolve(FLAGS_host, FLAGS_port);
+		latency[t].reserve(1 << 20);
+	}
+	for (size_t c = 0 ; c < FLAGS_connections ; ++c) {
+		size_t t = c % nthreads;
+		std::make_shared<ClientT>(*ios[t], endpoints[t], latency[t], errors[t], bytes[t], c)->Connect();
+	}
+
+	auto start = ClockT::now();
+	std::vector<std::thread> workers;
+	for (size_t t = 0 ; t < nthreads ; ++t)
+		workers.emplace_back([&ios, t] { ios[t]->run_for(std::chrono::seconds(FLAGS_seconds)); });
+	std::this_thread::sleep_for(std::chrono::seconds(FLAGS_seconds));
+	running = false;
+	for (auto& w : workers) w.join();
+	double took = std::chrono::duration<double>(ClockT::now() - start).count();
+
+	LatVecT all;
+	uint64_t nerrors = 0;
+	uint64_t nbytes = 0;
+	for (size_t t = 0 ; t < nthreads ; ++t) {
+		all.insert(all.end(), latency[t].begin(), latency[t].end());
+		nerrors += errors[t];
+		nbytes += bytes[t];
+	}
+	std::sort(all.begin(), all.end());
+	auto pct = [&all](double p) -> double {
+		return (all.empty()) ? 0 : all[ std::min<size_t>(all.size() - 1, (size_t)(p * all.size())) ] / 1000.0;
+	};
+
+	std::cout << "connections " << FLAGS_connections << " pipeline " << FLAGS_pipeline
+	          << " keepalive " << FLAGS_keepalive << " gzip " << FLAGS_gzip << std::endl;
+	std::cout << std::fixed << std::setprecision(1)
+	          << "requests " << all.size() << " errors " << nerrors
+	          << " req/s " << all.size() / took
+	          << " KB/s " << nbytes / took / 1024 << std::endl;
+	std::cout << std::setprecision(2)
+	          << "latency ms p50 " << pct(0.50) << " p90 " << pct(0.90)
+	          << " p99 " << pct(0.99) << " max " << pct(1.0) << std::endl;
+	return (nerrors==0) ? 0 : 1;
+}
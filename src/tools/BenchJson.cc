@@ -0,0 +1,225 @@
+/**
+ * @project zapdos
+ * @file src/tools/BenchJson.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  BenchJson.cc : Golden check and benchmark of search response json writers
+ *
+ */
+#define STRIP_FLAG_HELP 1
+#define STRIP_INTERNAL_FLAG_HELP 1
+#include <gflags/gflags.h>
+
+/* GFlags Start */
+DEFINE_bool(h, false, "Show help");
+DECLARE_bool(help);
+DECLARE_bool(helpshort);
+
+DEFINE_uint64(responses, 20000, "No of random responses to compare and time");
+DEFINE_int32(features, 10, "Max features per response");
+DEFINE_int32(rounds, 5, "No of rounds , best is shown");
+DEFINE_bool(codepoints, true, "Also compare every unicode code point in a string field");
+/* GFlags End */
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "query/PhotonJson.hpp"
+
+#define ZPDS_DEFAULT_EXE_NAME "zpds_benchjson"
+#define ZPDS_DEFAULT_EXE_VERSION "1.0.0"
+#define ZPDS_DEFAULT_EXE_COPYRIGHT "Copyright (c) 2020 S Roychowdhury"
+
+using PhotonVecT = std::vector<::zpds::query::PhotonResultT>;
+
+/**
+* Utf8 : encode a code point
+*
+*/
+std::string Utf8(uint32_t cp)
+{
+	std::string s;
+	if (cp < 0x80) s += char(cp);
+	else if (cp < 0x800) {
+		s += char(0xc0 | (cp >> 6));
+		s += char(0x80 | (cp & 0x3f));
+	}
+	else if (cp < 0x10000) {
+		s += char(0xe0 | (cp >> 12));
+		s += char(0x80 | ((cp >> 6) & 0x3f));
+		s += char(0x80 | (cp & 0x3f));
+	}
+	else {
+		s += char(0xf0 | (cp >> 18));
+		s += char(0x80 | ((cp >> 12) & 0x3f));
+		s += char(0x80 | ((cp >> 6) & 0x3f));
+		s += char(0x80 | (cp & 0x3f));
+	}
+	return s;
+}
+
+/**
+* Golden : compare with pb2json , print first few differences
+*
+*/
+bool Golden(const ::zpds::query::PhotonResultT& msg, size_t& mismatch)
+{
+	std::string want = ::zpds::query::pb2json(&msg);
+	std::string got;
+	::zpds::query::photon2json(&msg, got);
+	if (want==got) return true;
+	if (++mismatch <= 5)
+		std::cerr << "pb2json    : " << want << "\nphoton2json: " << got << std::endl;
+	return false;
+}
+
+/**
+* TimeIt : best of rounds in ns per response
+*
+*/
+template <typename F>
+double TimeIt(F&& func, size_t count)
+{
+	double best = 0;
+	for (int r=0 ; r < FLAGS_rounds ; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto took = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		if (r==0 || took < best) best = took;
+	}
+	return best / count;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string usage("Usage:\n");
+	usage += std::string(argv[0]) + " -responses 20000 -features 10\n" ;
+	gflags::SetUsageMessage(usage);
+	gflags::SetVersionString(ZPDS_DEFAULT_EXE_VERSION);
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_h) {
+		FLAGS_help = false;
+		FLAGS_helpshort = true;
+	}
+	gflags::HandleCommandLineHelpFlags();
+
+	size_t mismatch = 0;
+	size_t checked = 0;
+
+	// edge cases : blank parts , escapes , odd doubles
+	{
+		::zpds::query::PhotonResultT msg;
+		Golden(msg, mismatch);
+		msg.set_type("FeatureCollection");
+		Golden(msg, mismatch);
+		msg.add_features()->mutable_properties();
+		Golden(msg, mismatch);
+		checked += 3;
+		const double odd[] = { 0.0, -0.0, 0.1, 1e-5, 1e15, 1e16, 1e21, 5e-324, -1.0/3,
+		                       std::numeric_limits<double>::max(), std::numeric_limits<double>::quiet_NaN(),
+		                       std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()
+		                     };
+		for (auto d : odd) {
+			auto geom = msg.mutable_features(0)->mutable_geometry();
+			geom->add_coordinates(d);
+			msg.mutable_features(0)->mutable_properties()->add_extent(d);
+			Golden(msg, mismatch);
+			++checked;
+		}
+	}
+
+	if (FLAGS_codepoints) {
+		for (uint32_t cp = 1 ; cp < 0x110000 ; ++cp) {
+			if (cp >= 0xd800 && cp <= 0xdfff) continue;
+			::zpds::query::PhotonResultT msg;
+			msg.add_features()->mutable_properties()->set_name( "a" + Utf8(cp) + "b" );
+			Golden(msg, mismatch);
+			++checked;
+		}
+	}
+
+	// random responses like completions
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> dlat(-90, 90);
+	std::uniform_real_distribution<double> dlon(-180, 180);
+	const char* names[] = { "", "Connaught Place", "M\xc3\xbcnchen \"Altstadt\"", "a\\b <c>", "\xe0\xa4\xa6\xe0\xa4\xbf\xe0\xa4\xb2\xe0\xa5\x8d\xe0\xa4\xb2\xe0\xa5\x80" };
+	// stored coordinates come from text with about 7 decimals
+	auto coord = [&](std::uniform_real_distribution<double>& dist) {
+		return std::round( dist(gen) * 1e7 ) / 1e7;
+	};
+	PhotonVecT msgs(FLAGS_responses);
+	for (auto& msg : msgs) {
+		msg.set_type("FeatureCollection");
+		int n = gen() % (FLAGS_features + 1);
+		for (int i=0 ; i<n ; ++i) {
+			auto feat = msg.add_features();
+			feat->set_type("Feature");
+			auto prop = feat->mutable_properties();
+			prop->set_osm_id( (int64_t)gen() );
+			prop->set_osm_key("place");
+			prop->set_osm_value("suburb");
+			prop->set_osm_type("N");
+			prop->set_name( names[gen() % 5] );
+			prop->set_city( names[gen() % 5] );
+			prop->set_country("India");
+			prop->set_postcode( (gen() % 2) ? "110001" : "" );
+			if (gen() % 2) {
+				for (int j=0 ; j<4 ; ++j) prop->add_extent( coord(dlon) );
+			}
+			auto geom = feat->mutable_geometry();
+			geom->set_type("Point");
+			geom->add_coordinates( coord(dlon) );
+			geom->add_coordinates( (gen() % 8) ? coord(dlat) : dlat(gen) );
+		}
+		Golden(msg, mismatch);
+		++checked;
+	}
+
+	size_t bytes = 0;
+	double ns_pb = TimeIt( [&]() {
+		bytes = 0;
+		for (auto& msg : msgs) bytes += ::zpds::query::pb2json(&msg).length();
+	}, msgs.size());
+	double ns_fast = TimeIt( [&]() {
+		std::string out;
+		for (auto& msg : msgs) {
+			out.clear();
+			::zpds::query::photon2json(&msg, out);
+		}
+	}, msgs.size());
+
+	std::cout << "checked " << checked << " mismatch " << mismatch << std::endl;
+	std::cout << std::setw(12) << "pb2json" << std::setw(12) << std::fixed << std::setprecision(1) << ns_pb << " ns/response" << std::endl;
+	std::cout << std::setw(12) << "photon2json" << std::setw(12) << ns_fast << " ns/response"
+	          << "  speedup " << std::setprecision(2) << ns_pb / ns_fast
+	          << "  avg bytes " << bytes / std::max<size_t>(msgs.size(), 1) << std::endl;
+	return (mismatch==0) ? 0 : 1;
+}
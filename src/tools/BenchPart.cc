@@ -0,0 +1,209 @@
+/**
+ * @project zapdos
+ * @file src/tools/BenchPart.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  BenchPart.cc : zpds_benchpart : Partial word index length benchmark
+ *
+ */
+#define STRIP_FLAG_HELP 1
+#define STRIP_INTERNAL_FLAG_HELP 1
+#include <gflags/gflags.h>
+
+/* GFlags Start */
+DEFINE_bool(h, false, "Show help");
+DECLARE_bool(help);
+DECLARE_bool(helpshort);
+
+DEFINE_string(input, "", "File with one place name per line , eg from a nominatim extract");
+DEFINE_string(xapath, "", "Scratch directory for the indexes , must not exist");
+DEFINE_uint64(docs, 1000000, "Max names to index");
+DEFINE_uint64(limit, 4, "Max partial length to compare with indexing all lengths");
+DEFINE_uint64(queries, 1000, "No of query words sampled from the names");
+DEFINE_uint64(maxlen, 10, "Query prefix lengths from 1 to this");
+DEFINE_uint64(items, 10, "Results per query");
+/* GFlags End */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <boost/filesystem.hpp>
+
+#include "search/IndexLocal.hpp"
+#include "utils/SplitWith.hpp"
+
+#define ZPDS_DEFAULT_EXE_NAME "zpds_benchpart"
+#define ZPDS_DEFAULT_EXE_VERSION "1.0.0"
+#define ZPDS_DEFAULT_EXE_COPYRIGHT "Copyright (c) 2020 S Roychowdhury"
+
+using WordVecT = ::zpds::search::BaseUtils::WordVecT;
+using IdVecT = std::vector<Xapian::docid>;
+
+// Handle for LocaldataT documents
+class HandleLocal : virtual public ::zpds::search::IndexLocal {
+public:
+	using ::zpds::search::IndexLocal::IndexLocal;
+};
+
+/**
+* DirSize : bytes in files under path
+*
+*/
+uint64_t DirSize(const std::string& path)
+{
+	uint64_t bytes = 0;
+	for (auto& entry : boost::filesystem::recursive_directory_iterator(path))
+		if (boost::filesystem::is_regular_file(entry.status())) bytes += boost::filesystem::file_size(entry.path());
+	return bytes;
+}
+
+/**
+* Ingest : index names with the partial length limit , returns docs per second
+*
+*/
+double Ingest(const std::string& path, const WordVecT& names, size_t limit)
+{
+	::zpds::search::BaseUtils::SetPartLimit(limit);
+	HandleLocal handle;
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> dimp(0.0, 1.0);
+
+	auto start = std::chrono::steady_clock::now();
+	Xapian::WritableDatabase db(path, Xapian::DB_CREATE | Xapian::DB_DANGEROUS);
+	for (size_t i=0 ; i < names.size() ; ++i) {
+		::zpds::store::ItemDataT record;
+		record.set_id(i+1);
+		record.set_lang( ::zpds::search::LangTypeE::EN );
+		record.set_fld_name( names[i] );
+		record.set_importance( dimp(gen) );
+		::zpds::search::IndexBase& index = handle;
+		db.add_document( index.CreateDoc(&record) );
+	}
+	db.commit();
+	db.close();
+	auto took = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return names.size() / took;
+}
+
+/**
+* Search : top items by importance for a partial word as the search path builds it
+*
+*/
+IdVecT Search(Xapian::Database& db, const std::string& word, size_t limit)
+{
+	std::string qstr = ( limit > 0 && word.length() > limit ) ? "+" + word + "*" : "+" XAP_PARTWORD_PREFIX + word;
+	Xapian::QueryParser queryparser;
+	queryparser.set_database(db);
+	Xapian::Query query = queryparser.parse_query(qstr,
+	                      Xapian::QueryParser::FLAG_LOVEHATE | Xapian::QueryParser::FLAG_BOOLEAN | Xapian::QueryParser::FLAG_WILDCARD);
+	Xapian::Enquire enquire(db);
+	enquire.set_weighting_scheme(Xapian::BoolWeight());
+	enquire.set_query(query);
+	enquire.set_sort_by_value(XAP_IMPORTANCE_POS,true);
+	Xapian::MSet mset = enquire.get_mset(0, FLAGS_items);
+	IdVecT ids;
+	for (Xapian::MSetIterator m = mset.begin(); m != mset.end(); ++m) ids.push_back(*m);
+	return ids;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string usage("Usage:\n");
+	usage += std::string(argv[0]) + " -input names.txt -xapath /tmp/benchpart -limit 4\n" ;
+	gflags::SetUsageMessage(usage);
+	gflags::SetVersionString(ZPDS_DEFAULT_EXE_VERSION);
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_h) {
+		FLAGS_help = false;
+		FLAGS_helpshort = true;
+	}
+	gflags::HandleCommandLineHelpFlags();
+
+	if (FLAGS_input.empty() || FLAGS_xapath.empty()) {
+		std::cerr << "input and xapath are needed" << std::endl;
+		return 1;
+	}
+	if (boost::filesystem::exists(FLAGS_xapath)) {
+		std::cerr << "xapath already exists" << std::endl;
+		return 1;
+	}
+
+	WordVecT names;
+	{
+		std::ifstream in(FLAGS_input);
+		std::string line;
+		while (names.size() < FLAGS_docs && std::getline(in, line))
+			if (!line.empty()) names.emplace_back(line);
+	}
+	if (names.empty()) {
+		std::cerr << "no names in input" << std::endl;
+		return 1;
+	}
+
+	// query words from the names , as typed they are lowercase
+	WordVecT words;
+	{
+		std::mt19937_64 gen(7);
+		std::uniform_int_distribution<size_t> dpick(0, names.size()-1);
+		for (size_t i=0 ; i < FLAGS_queries * 10 && words.size() < FLAGS_queries ; ++i) {
+			for (auto& word : ::zpds::utils::SplitWith::LowerNoQuote( names[dpick(gen)] ) ) {
+				if (word.length() >= FLAGS_maxlen) {
+					words.emplace_back(word);
+					break;
+				}
+			}
+		}
+	}
+
+	const size_t limits[] = { 0, FLAGS_limit };
+	std::vector<std::vector<IdVecT>> results(2);
+	std::cout << "names " << names.size() << " query words " << words.size() << std::endl;
+	for (size_t l=0 ; l < 2 ; ++l) {
+		std::string path = FLAGS_xapath + "/" + std::to_string(limits[l]);
+		boost::filesystem::create_directories(FLAGS_xapath);
+		double rate = Ingest(path, names, limits[l]);
+		std::cout << "part_limit " << limits[l] << std::fixed << std::setprecision(0)
+		          << "  index " << DirSize(path) / 1024 << " KB"
+		          << "  ingest " << rate << " docs/s" << std::endl;
+
+		Xapian::Database db(path);
+		for (size_t len=1 ; len <= FLAGS_maxlen ; ++len) {
+			auto start = std::chrono::steady_clock::now();
+			for (auto& word : words) results[l].emplace_back( Search(db, word.substr(0,len), limits[l]) );
+			auto took = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			std::cout << std::setw(6) << len << std::setw(12) << std::setprecision(1) << took / words.size() << " us/query" << std::endl;
+		}
+	}
+
+	// same importance sort so results should only differ by stems and shingles
+	size_t differ = 0;
+	for (size_t i=0 ; i < results[0].size() ; ++i) differ += ( results[0][i] != results[1][i] );
+	std::cout << "queries with different results " << differ << " of " << results[0].size() << std::endl;
+	return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @project zapdos
+ * @file src/tools/BenchShared.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  BenchShared.cc : Contention of shared flags , counters and strings under many threads
+ *
+ */
+#define STRIP_FLAG_HELP 1
+#define STRIP_INTERNAL_FLAG_HELP 1
+#include <gflags/gflags.h>
+
+/* GFlags Start */
+DEFINE_bool(h, false, "Show help");
+DECLARE_bool(help);
+DECLARE_bool(helpshort);
+
+DEFINE_uint64(threads, 32, "No of threads");
+DEFINE_uint64(millis, 2000, "Duration of each case in ms");
+DEFINE_uint64(write_every, 10000, "Each thread sets the value once in these many reads , 0 for never");
+/* GFlags End */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "utils/SharedCounter.hpp"
+
+#define ZPDS_DEFAULT_EXE_NAME "zpds_benchshared"
+#define ZPDS_DEFAULT_EXE_VERSION "1.0.0"
+#define ZPDS_DEFAULT_EXE_COPYRIGHT "Copyright (c) 2020 S Roychowdhury"
+
+using ClockT = std::chrono::steady_clock;
+
+/**
+* LockedObject : the read write locked object shared values used to be , for comparison
+*
+*/
+template <class T>
+class LockedObject {
+public:
+	using LockT = boost::shared_mutex;
+	using WriteLockT = boost::unique_lock< LockT >;
+	using ReadLockT = boost::shared_lock< LockT >;
+
+	LockedObject(T t) : t_(t) {}
+
+	void Set(T t)
+	{
+		WriteLockT writelock(mutex_);
+		t_=t;
+	}
+
+	T Get()
+	{
+		ReadLockT readlock(mutex_);
+		return t_;
+	}
+
+	uint64_t GetNext()
+	{
+		WriteLockT writelock(mutex_);
+		return ++t_;
+	}
+
+protected:
+	T t_;
+	LockT mutex_;
+};
+
+/**
+* Run : ops per second of read over all threads , with a set once in write_every reads
+*
+*/
+template <class ReadT, class WriteT>
+double Run(ReadT read, WriteT write)
+{
+	std::atomic<bool> running(true);
+	std::atomic<uint64_t> total(0);
+	std::vector<std::thread> workers;
+	for (size_t t = 0 ; t < FLAGS_threads ; ++t) {
+		workers.emplace_back([&running, &total, &read, &write, t] {
+			uint64_t ops = 0;
+			uint64_t sink = 0;
+			while (running.load(std::memory_order_relaxed)) {
+				for (size_t i = 0 ; i < 256 ; ++i) {
+					if (FLAGS_write_every>0 && (ops + t) % FLAGS_write_every == 0) write(ops);
+					else sink += read();
+					++ops;
+				}
+			}
+			total += ops + (sink & 0);
+		});
+	}
+	auto start = ClockT::now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_millis));
+	running = false;
+	for (auto& w : workers) w.join();
+	double took = std::chrono::duration<double>(ClockT::now() - start).count();
+	return total.load() / took;
+}
+
+/**
+* Report : print one case
+*
+*/
+void Report(const std::string& name, double locked, double shared)
+{
+	std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+	          << " locked Mops/s " << std::setw(9) << locked / 1e6
+	          << " shared Mops/s " << std::setw(9) << shared / 1e6
+	          << " x " << std::setprecision(2) << shared / locked << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string usage("Usage:\n");
+	usage += std::string(argv[0]) + " -threads 32 -millis 2000 -write_every 10000\n" ;
+	gflags::SetUsageMessage(usage);
+	gflags::SetVersionString(ZPDS_DEFAULT_EXE_VERSION);
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_h) {
+		FLAGS_help = false;
+		FLAGS_helpshort = true;
+	}
+	gflags::HandleCommandLineHelpFlags();
+	if (FLAGS_threads==0) FLAGS_threads=1;
+
+	std::cout << "threads " << FLAGS_threads << " write_every " << FLAGS_write_every
+	          << " cpus " << std::thread::hardware_concurrency() << std::endl;
+
+	{
+		// is_ready , is_master and the like
+		LockedObject<bool> lflag(true);
+		zpds::utils::SharedObject<bool> sflag(true);
+		double l = Run([&lflag] { return uint64_t(lflag.Get()); }, [&lflag](uint64_t) { lflag.Set(true); });
+		double s = Run([&sflag] { return uint64_t(sflag.Get()); }, [&sflag](uint64_t) { sflag.Set(true); });
+		Report("bool", l, s);
+	}
+	{
+		// maincounter and logcounter , every op is a write
+		LockedObject<uint64_t> lcounter(0);
+		zpds::utils::SharedCounter scounter;
+		double l = Run([&lcounter] { return lcounter.GetNext(); }, [&lcounter](uint64_t) { lcounter.GetNext(); });
+		double s = Run([&scounter] { return scounter.GetNext(); }, [&scounter](uint64_t) { scounter.GetNext(); });
+		Report("counter", l, s);
+	}
+	{
+		// master , hostname , shared_secret
+		const std::string value("http://master.example.com:9093");
+		LockedObject<std::string> lstring(value);
+		zpds::utils::SharedObject<std::string> sstring(value);
+		double l = Run([&lstring] { return uint64_t(lstring.Get().size()); }, [&lstring,&value](uint64_t) { lstring.Set(value); });
+		double s = Run([&sstring] { return uint64_t(sstring.Get().size()); }, [&sstring,&value](uint64_t) { sstring.Set(value); });
+		double p = Run([&sstring] { return uint64_t(sstring.GetPtr()->size()); }, [&sstring,&value](uint64_t) { sstring.Set(value); });
+		Report("string", l, s);
+		Report("string ptr", l, p);
+	}
+	{
+		// maindb and logdb
+		auto value = std::make_shared<uint64_t>(1);
+		LockedObject<std::shared_ptr<uint64_t>> lpointer(value);
+		zpds::utils::SharedObject<std::shared_ptr<uint64_t>> spointer(value);
+		double l = Run([&lpointer] { return *lpointer.Get(); }, [&lpointer,&value](uint64_t) { lpointer.Set(value); });
+		double s = Run([&spointer] { return *spointer.Get(); }, [&spointer,&value](uint64_t) { spointer.Set(value); });
+		Report("dbpointer", l, s);
+	}
+	return 0;
+}
@@ -73,6 +73,11 @@ DEFINE_validator(errorlog, &IsNonEmptyMessage);
 DEFINE_string(indextype, "", "Index Type: Should be localdata or wikidata");
 DEFINE_validator(indextype, &IsValidDType);
 
+DEFINE_int32(shards, 1, "Shards per index, should match server xapian shards");
+DEFINE_validator(shards, &IsPositive);
+
+DEFINE_uint64(partlimit, 0, "Max length of partial words indexed, 0 for all, should match server part_limit");
+
 DEFINE_bool(nomerge, false, "Flag for skipping merge indexes created");
 DEFINE_bool(noindex, false, "Flag for merge only assuming indexes created");
 
@@ -83,6 +88,7 @@ DEFINE_bool(noindex, false, "Flag for merge only assuming indexes created");
 #include <functional>
 #include <thread>
 #include <chrono>
+#include <fstream>
 
 #include <exception>
 #include <stdexcept>
@@ -118,15 +124,11 @@ public:
 	void Process(::zpds::store::KeyTypeE keytype, JobQuePtr jq);
 };
 
-// Handle for Write Index
+// Handle for Write Index , shards as the server , opened dangerous for bulk
 class HandleWrite : virtual public zpds::search::WriteIndex {
 public:
 	using DatabaseT = Xapian::WritableDatabase;
-	using ::zpds::search::WriteIndex::WriteIndex;
-	void Update(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
-	            const std::string& idterm, ::Xapian::Document&& doc) override;
-protected:
-	DatabaseT& Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp) override;
+	HandleWrite(const std::string& path, size_t shards);
 };
 
 // Handle for LocaldataT index
@@ -136,7 +138,7 @@ public:
 	using DatabaseT = Xapian::WritableDatabase;
 	using pointer = std::shared_ptr<HandleIndex>;
 	HandleIndex() = delete;
-	HandleIndex(const std::string& path);
+	HandleIndex(const std::string& path, size_t shards);
 	void Process(::zpds::utils::SharedTable::pointer stptr, JobQuePtr jq);
 protected:
 	HandleWrite index;
@@ -209,6 +211,7 @@ int main(int argc, char *argv[])
 
 			// indextype
 			std::string& indextype = FLAGS_indextype;
+			::zpds::search::BaseUtils::SetPartLimit( FLAGS_partlimit );
 
 			auto stptr = zpds::utils::SharedTable::create();
 
@@ -233,10 +236,11 @@ int main(int argc, char *argv[])
 				std::string mypath = FLAGS_xapath + "/" + std::to_string(i);
 				boost::filesystem::create_directories(mypath);
 
-				mythreads.emplace_back( std::thread([indextype, mypath, stptr, jqueue]() {
+				size_t shards = FLAGS_shards;
+				mythreads.emplace_back( std::thread([indextype, mypath, shards, stptr, jqueue]() {
 					std::shared_ptr<HandleIndex> iptr{nullptr};
-					if ( indextype == "localdata" ) iptr.reset(new HandleLocal(mypath) );
-					else if ( indextype == "wikidata" ) iptr.reset(new HandleWiki(mypath) );
+					if ( indextype == "localdata" ) iptr.reset(new HandleLocal(mypath, shards) );
+					else if ( indextype == "wikidata" ) iptr.reset(new HandleWiki(mypath, shards) );
 					else throw ::zpds::BadCodeException("Unknown index type");
 					iptr->Process(stptr,jqueue);
 				}) );
@@ -284,16 +288,37 @@ int main(int argc, char *argv[])
 			else if ( FLAGS_indextype == "wikidata" ) itype = "I_WIKIDATA";
 			else throw ::zpds::BadCodeException("Unknown index type");
 
+			// shards as written by the index step
+			size_t shards = 0;
+			{
+				std::ifstream in( FLAGS_xapath + "/0/" + XAP_SHARDS_FILE );
+				if (in.is_open()) in >> shards;
+			}
+			if (shards==0) shards = 1;
+			if (shards != (size_t)FLAGS_shards)
+				throw zpds::InitialException("index has " + std::to_string(shards) + " shards, run with -shards " + std::to_string(shards));
+
 			const google::protobuf::EnumDescriptor *l = zpds::search::LangTypeE_descriptor();
 			for (auto i=0 ; i < l->value_count() ; ++i ) {
-				std::string fname { l->value(i)->name() + "_" +  itype };
-				std::vector<std::string> paths;
-				for (auto i=0 ; i < FLAGS_threads ; ++i ) {
-					paths.emplace_back( FLAGS_xapath + "/" + std::to_string(i) + "/" + fname );
+				for (size_t k=0 ; k < shards ; ++k ) {
+					// same layout as WriteIndex::ShardPath
+					std::string fname { l->value(i)->name() + "_" +  itype };
+					if (k>0) fname += "_" + std::to_string(k);
+					std::vector<std::string> paths;
+					for (auto i=0 ; i < FLAGS_threads ; ++i ) {
+						paths.emplace_back( FLAGS_xapath + "/" + std::to_string(i) + "/" + fname );
+					}
+					MergeIndex mi;
+					std::string mpath = mainpath + "/" + fname;
+					mi.Process(mpath, paths);
 				}
-				MergeIndex mi;
-				std::string mpath = mainpath + "/" + fname;
-				mi.Process(mpath, paths);
+			}
+
+			// server checks its shards against this
+			{
+				std::ofstream out( mainpath + "/" + XAP_SHARDS_FILE, std::ios::trunc );
+				out << shards;
+				if (!out) throw zpds::InitialException("cannot write " + mainpath + "/" + XAP_SHARDS_FILE);
 			}
 
 		}
@@ -323,27 +348,11 @@ int main(int argc, char *argv[])
 /* Class Function Definitions */
 
 /* HandleWrite */
-void HandleWrite::Update(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp,
-                         const std::string& idterm, ::Xapian::Document&& doc) 
-{
-	Get(ltyp, dtyp).replace_document(idterm, doc);
-}
-
-HandleWrite::DatabaseT& HandleWrite::Get(::zpds::search::LangTypeE ltyp, ::zpds::search::IndexTypeE dtyp)
-{
-	const google::protobuf::EnumDescriptor *l = zpds::search::LangTypeE_descriptor();
-	const google::protobuf::EnumDescriptor *d = zpds::search::IndexTypeE_descriptor();
-	int f = (ltyp * 1000) + dtyp;
-	if ( triemap.find(f) == triemap.end() ) {
-		const std::string xapath{dbpath + "/" + l->FindValueByNumber(ltyp)->name() + "_" + d->FindValueByNumber(dtyp)->name()};
-		if (!boost::filesystem::exists(xapath)) boost::filesystem::create_directories(xapath);
-		triemap[f] = DatabaseT(xapath, Xapian::DB_CREATE_OR_OPEN | Xapian::DB_DANGEROUS);
-	}
-	return triemap.at(f);
-}
+HandleWrite::HandleWrite(const std::string& path, size_t shards)
+	: ::zpds::search::WriteIndex(path, shards, Xapian::DB_CREATE_OR_OPEN | Xapian::DB_DANGEROUS) {}
 
 /* HandleIndex */
-HandleIndex::HandleIndex(const std::string& path) : index(path) {}
+HandleIndex::HandleIndex(const std::string& path, size_t shards) : index(path, shards) {}
 
 void HandleIndex::Process(::zpds::utils::SharedTable::pointer stptr, JobQuePtr jq)
 {
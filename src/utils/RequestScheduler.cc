@@ -0,0 +1,240 @@
+/**
+ * @project zapdos
+ * @file src/utils/RequestScheduler.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  RequestScheduler.cc : Bounded request queues by traffic class impl
+ *
+ */
+#include "utils/RequestScheduler.hpp"
+
+/**
+ * Constructor : default
+ *
+ */
+zpds::utils::RequestScheduler::RequestScheduler(const ParamsListT& params_)
+{
+	for (size_t i=0 ; i < REQ_CLASSES ; ++i) {
+		ParamsT p = (i < params_.size()) ? params_[i] : ParamsT();
+		queues[i].threads = (p.threads>0) ? p.threads : ZPDS_SCHED_DEFAULT_THREADS;
+		queues[i].capacity = (p.queue>0) ? p.queue : ZPDS_SCHED_DEFAULT_QUEUE;
+		queues[i].deadline_ms = p.deadline_ms;
+		queues[i].cpus = p.cpus;
+	}
+}
+
+/**
+ * Destructor : stops the threads
+ *
+ */
+zpds::utils::RequestScheduler::~RequestScheduler()
+{
+	Stop();
+}
+
+/**
+* Start : start the threads of all classes
+*
+*/
+void zpds::utils::RequestScheduler::Start()
+{
+	for (auto& q : queues) {
+		std::lock_guard<std::mutex> lock(q.lock);
+		if (!q.workers.empty()) continue;
+		q.stopping=false;
+		for (size_t i=0 ; i < q.threads ; ++i)
+			q.workers.emplace_back( std::thread(&RequestScheduler::Work, this, &q) );
+	}
+}
+
+/**
+* Stop : run what is queued and stop the threads
+*
+*/
+void zpds::utils::RequestScheduler::Stop()
+{
+	for (auto& q : queues) {
+		{
+			std::lock_guard<std::mutex> lock(q.lock);
+			q.stopping=true;
+		}
+		q.cv.notify_all();
+	}
+	for (auto& q : queues) {
+		for (auto& t : q.workers) t.join();
+		q.workers.clear();
+	}
+}
+
+/**
+* Submit : queue a request
+*
+*/
+bool zpds::utils::RequestScheduler::Submit(ClassE cls, TaskT&& task, TaskT&& reject)
+{
+	QueueT& q = queues[cls];
+	auto now = ClockT::now();
+	bool refuse = false;
+	{
+		std::lock_guard<std::mutex> lock(q.lock);
+		refuse = q.stopping || q.jobs.size() >= q.capacity;
+		// the oldest waiting is already late , this one would be too
+		if (!refuse && q.deadline_ms>0 && !q.jobs.empty())
+			refuse = ( now - q.jobs.front().queued_at > std::chrono::milliseconds(q.deadline_ms) );
+		if (!refuse) {
+			q.jobs.push_back( JobT{ std::move(task), std::move(reject), now } );
+			++q.depth;
+		}
+	}
+	if (refuse) {
+		++q.shed;
+		reject();
+		return false;
+	}
+	++q.accepted;
+	q.cv.notify_one();
+	return true;
+}
+
+/**
+* Work : worker thread loop of a class , late requests get their reject
+*
+*/
+void zpds::utils::RequestScheduler::Work(QueueT* q)
+{
+	ThreadPin::PinSelf(q->cpus);
+	while (true) {
+		JobT job;
+		{
+			std::unique_lock<std::mutex> lock(q->lock);
+			q->cv.wait(lock, [q] { return q->stopping || !q->jobs.empty(); });
+			if (q->jobs.empty()) break; // stopping and drained
+			job = std::move(q->jobs.front());
+			q->jobs.pop_front();
+			--q->depth;
+		}
+
+		uint64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(ClockT::now() - job.queued_at).count();
+		try {
+			if (q->deadline_ms>0 && waited > q->deadline_ms * 1000) {
+				++q->expired;
+				job.reject();
+				continue;
+			}
+			q->wait_total += waited;
+			++q->started;
+			uint64_t wmax = q->wait_max.load();
+			while (waited > wmax && !q->wait_max.compare_exchange_weak(wmax, waited)) {}
+			job.task();
+			++q->done;
+		}
+		catch (std::exception& e) {
+			LOG(INFO) << "RequestScheduler " << GetName( ClassE(q - queues) ) << " error: " << e.what();
+		}
+		catch (...) {
+			LOG(INFO) << "RequestScheduler " << GetName( ClassE(q - queues) ) << " unknown error";
+		}
+	}
+}
+
+/**
+* GetName : class name for counters
+*
+*/
+const char* zpds::utils::RequestScheduler::GetName(ClassE cls)
+{
+	switch (cls) {
+	case REQ_QUERY:
+		return "query";
+	case REQ_ADMIN:
+		return "admin";
+	case REQ_HRPC:
+		return "hrpc";
+	default:
+		return "unknown";
+	}
+}
+
+/**
+* Get : queue of a class
+*
+*/
+const zpds::utils::RequestScheduler::QueueT& zpds::utils::RequestScheduler::Get(ClassE cls) const
+{
+	if (cls >= REQ_CLASSES) throw zpds::BadCodeException("request class out of range");
+	return queues[cls];
+}
+
+/**
+* GetThreads , GetDepth , GetAccepted , GetDone , GetShed , GetExpired : counters by class
+*
+*/
+uint64_t zpds::utils::RequestScheduler::GetThreads(ClassE cls) const
+{
+	return Get(cls).threads;
+}
+
+uint64_t zpds::utils::RequestScheduler::GetDepth(ClassE cls) const
+{
+	return Get(cls).depth.load();
+}
+
+uint64_t zpds::utils::RequestScheduler::GetAccepted(ClassE cls) const
+{
+	return Get(cls).accepted.load();
+}
+
+uint64_t zpds::utils::RequestScheduler::GetDone(ClassE cls) const
+{
+	return Get(cls).done.load();
+}
+
+uint64_t zpds::utils::RequestScheduler::GetShed(ClassE cls) const
+{
+	return Get(cls).shed.load();
+}
+
+uint64_t zpds::utils::RequestScheduler::GetExpired(ClassE cls) const
+{
+	return Get(cls).expired.load();
+}
+
+/**
+* GetWaitAvg , GetWaitMax : queue wait in microseconds of requests run , by class
+*
+*/
+uint64_t zpds::utils::RequestScheduler::GetWaitAvg(ClassE cls) const
+{
+	const QueueT& q = Get(cls);
+	uint64_t started = q.started.load();
+	return (started>0) ? q.wait_total.load() / started : 0;
+}
+
+uint64_t zpds::utils::RequestScheduler::GetWaitMax(ClassE cls) const
+{
+	return Get(cls).wait_max.load();
+}
@@ -33,6 +33,8 @@
 #include <locale>
 #include <sstream>
 #include <functional>
+#include <cstdlib>
+#include <cctype>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/regex.hpp>
 
@@ -99,3 +101,33 @@ std::vector<std::string> zpds::utils::SplitWith::Regex(const std::string& input,
 		);
 	return output;
 }
+
+/**
+* Box : split a geometry like BOX(x1 y1,x2 y2) into its four numbers , without regex
+*
+*/
+bool zpds::utils::SplitWith::Box(const std::string& input, std::vector<double>& extent)
+{
+	extent.clear();
+	size_t pos = input.find("BOX(");
+	if (pos==std::string::npos) return false;
+	pos += 4;
+
+	const char ends[] = { ' ', ',', ' ', ')' };
+	for (auto end : ends) {
+		size_t last = pos;
+		while ( pos < input.length() && ( std::isdigit( static_cast<unsigned char>(input[pos]) ) || input[pos]=='-' || input[pos]=='.' ) ) ++pos;
+		if ( pos==last || pos >= input.length() || input[pos]!=end ) break;
+
+		// the number has to take all of its characters
+		std::string num = input.substr(last, pos-last);
+		char* eptr = nullptr;
+		double d = std::strtod(num.c_str(), &eptr);
+		if ( eptr != num.c_str() + num.length() ) break;
+		extent.push_back(d);
+		++pos;
+	}
+	if (extent.size()==4) return true;
+	extent.clear();
+	return false;
+}
@@ -0,0 +1,103 @@
+/**
+ * @project zapdos
+ * @file src/utils/ThreadPin.cc
+ * @author  S Roychowdhury < sroycode at gmail dot com >
+ * @version 1.0.0
+ *
+ * @section LICENSE
+ *
+ * Copyright (c) 2018-2020 S Roychowdhury
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *  ThreadPin.cc : Pin threads to cpu sets or numa nodes impl
+ *
+ */
+#include "utils/ThreadPin.hpp"
+#include "utils/BaseUtils.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <boost/algorithm/string.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define ZPDS_NUMA_NODE_PREFIX "node"
+#define ZPDS_NUMA_NODE_PATH "/sys/devices/system/node/"
+
+/**
+* Parse : cpus from a list like 0-3,8 , a numa node as node1 takes its cpus
+*
+*/
+zpds::utils::ThreadPin::CpuListT zpds::utils::ThreadPin::Parse(const std::string& input)
+{
+	CpuListT cpus;
+	std::vector<std::string> parts;
+	boost::algorithm::split(parts, input, boost::algorithm::is_any_of(","));
+	for (auto& part : parts) {
+		boost::algorithm::trim(part);
+		if (part.empty()) continue;
+		try {
+			if (boost::algorithm::starts_with(part, ZPDS_NUMA_NODE_PREFIX)) {
+				std::string node = part.substr( strlen(ZPDS_NUMA_NODE_PREFIX) );
+				std::ifstream cpulist( ZPDS_NUMA_NODE_PATH ZPDS_NUMA_NODE_PREFIX + std::to_string( std::stoul(node) ) + "/cpulist" );
+				std::string nodecpus;
+				if (!std::getline(cpulist, nodecpus) || nodecpus.empty())
+					throw zpds::ConfigException("no such numa node: " + part);
+				CpuListT more = Parse(nodecpus);
+				cpus.insert(cpus.end(), more.begin(), more.end());
+				continue;
+			}
+			size_t dash = part.find('-');
+			unsigned long first = std::stoul( part.substr(0, dash) );
+			unsigned long last = (dash==std::string::npos) ? first : std::stoul( part.substr(dash+1) );
+			if (last < first) throw zpds::ConfigException("bad cpu range: " + part);
+			for (unsigned long i=first ; i<=last ; ++i) cpus.push_back(i);
+		}
+		catch (std::logic_error& e) {
+			throw zpds::ConfigException("bad cpu list: " + input);
+		}
+	}
+	return cpus;
+}
+
+/**
+* PinSelf : pin the calling thread to cpus
+*
+*/
+bool zpds::utils::ThreadPin::PinSelf(const CpuListT& cpus)
+{
+	if (cpus.empty()) return false;
+#ifdef __linux__
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (auto& cpu : cpus)
+		if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpuset);
+	int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+	if (rc!=0) LOG(INFO) << "ThreadPin failed with error " << rc;
+	return (rc==0);
+#else
+	LOG(INFO) << "ThreadPin not supported on this platform";
+	return false;
+#endif
+}
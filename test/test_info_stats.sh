@@ -0,0 +1,10 @@
+#!/bin/bash
+export SRCDIR=$(dirname $(cd ${0%/*} 2>>/dev/null ; echo `pwd`/${0##*/}))
+export SRCFIL=$(basename $(cd ${0%/*} 2>>/dev/null ; echo `pwd`/${0##*/}))
+. ${SRCDIR}/config.sh
+
+## ---- variables
+
+## ---- main
+
+${HTTPIE} GET ${TESTURL}/stats
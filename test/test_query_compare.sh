@@ -0,0 +1,32 @@
+#!/bin/bash
+export SRCDIR=$(dirname $(cd ${0%/*} 2>>/dev/null ; echo `pwd`/${0##*/}))
+export SRCFIL=$(basename $(cd ${0%/*} 2>>/dev/null ; echo `pwd`/${0##*/}))
+. ${SRCDIR}/config.sh
+
+## ---- variables
+## compares completion results of TESTURL with BASEURL , a server built from an older tree on the same data
+if [ -z "${BASEURL}" ] ; then echo "define BASEURL of the server to compare with"; exit 1; fi
+export profile=${profile:="default"};
+export lon=${lon:="88.88888"};
+export lat=${lat:="22.22222"};
+queries=${queries:="c ch che chem chemi chemist chemists chem_ chemist_sh new_y new_york_ rd road_ st_ 12 12th_ c_h a_b_c x-y o'neil
+ chem+OR+road chem+AND+x NOT+chem chem* +chem -road (chem)"}
+scripts="test_query_completion_photon.sh test_query_completion_textdata.sh"
+
+## ---- main
+set -f
+differ=0
+for script in ${scripts} ; do
+	for q in ${queries} ; do
+		# underscore stands for space so trailing space keeps the last word full
+		qs="`echo "${q}" | tr '_+' '  '`"
+		new="`TESTBATCH=0 TESTHEADERS=0 TESTURL=${TESTURL} q="${qs}" bash ${SRCDIR}/${script} | jq -S -c .`"
+		old="`TESTBATCH=0 TESTHEADERS=0 TESTURL=${BASEURL} q="${qs}" bash ${SRCDIR}/${script} | jq -S -c .`"
+		if [ "${new}" != "${old}" ] ; then
+			echo "DIFF ${script} q=\"${qs}\" : ${old} => ${new}"
+			differ=$((differ+1))
+		fi
+	done
+done
+echo "${differ} differences"
+[ ${differ} -eq 0 ]